@@ -0,0 +1,53 @@
+#include "_bench_util.h"
+
+#include <qlist.h>
+#include <qsqldatabase.h>
+#include <qsqlquery.h>
+#include <qstring.h>
+
+#include <QStringBuilder>
+#include <iterator>
+
+using yd_gui::VideoFormat, yd_gui::VideoInfo;
+
+namespace bench_util {
+
+QString unique_connection_name(const char* prefix) {
+    static qint64 counter = 0;
+    return QString(prefix) % "_" % QString::number(counter++);
+}
+
+qint64 database_size(const QString& connection_name) {
+    QSqlQuery query(QSqlDatabase::database(connection_name));
+    if (!query.exec("PRAGMA wal_checkpoint(TRUNCATE);") ||
+        !query.exec("SELECT page_count * page_size "
+                    "FROM pragma_page_count(), pragma_page_size();") ||
+        !query.next()) {
+        return -1;
+    }
+    return query.value(0).toLongLong();
+}
+
+VideoInfo make_sample_info(const qint64 index) {
+    static constexpr qint64 kFormatsPerVideo = 24;
+    static constexpr quint32 kHeights[] = {144, 240, 360, 480, 720, 1080};
+
+    QList<VideoFormat> formats;
+    formats.reserve(kFormatsPerVideo);
+    for (qint64 i = 0; i < kFormatsPerVideo; ++i) {
+        const quint32 height = kHeights[i % std::size(kHeights)];
+        formats << VideoFormat(QString::number(100 + i),
+                               i % 2 == 0 ? "mp4" : "webm", height * 16 / 9,
+                               height, i % 3 == 0 ? 60 : 30);
+    }
+
+    const QString id = QString::number(index);
+    return VideoInfo("video" % id, "Sample video title number " % id,
+                     "Sample channel " % QString::number(index % 500),
+                     static_cast<quint32>(60 + index % 3600),
+                     "https://i.ytimg.com/vi/" % id % "/maxresdefault.jpg",
+                     "https://youtu.be/" % id, std::move(formats),
+                     index % 10 != 0);
+}
+
+}  // namespace bench_util
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <qstring.h>
+#include <qtypes.h>
+#include <video.h>
+
+namespace bench_util {
+
+// Unique per call so every benchmark run gets its own connection
+QString unique_connection_name(const char* prefix);
+
+// Size in bytes of the database behind connection_name, with its WAL
+// checkpointed into the main file first
+qint64 database_size(const QString& connection_name);
+
+// A video shaped like a typical yt-dlp fetch, i.e., a couple dozen formats
+yd_gui::VideoInfo make_sample_info(qint64 index);
+
+}  // namespace bench_util
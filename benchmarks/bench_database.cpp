@@ -0,0 +1,73 @@
+#include <benchmark/benchmark.h>
+#include <database.h>
+#include <qsqldatabase.h>
+#include <qtemporarydir.h>
+
+#include <array>
+#include <iterator>
+
+#include "_bench_util.h"
+
+using namespace bench_util;  // NOLINT(google-build-using-namespace)
+
+namespace yd_gui {
+
+namespace {
+
+struct PragmaProfile {
+    const char* name;
+    DatabasePragmas pragmas;
+};
+
+// Ordered from SQLite's defaults to the settings the app uses
+const std::array kPragmaProfiles{
+    PragmaProfile{"delete_full", {.journal_mode = "DELETE",
+                                  .synchronous = "FULL",
+                                  .mmap_size = 0,
+                                  .cache_size_kib = 2000}},
+    PragmaProfile{"wal_full", {.journal_mode = "WAL",
+                               .synchronous = "FULL",
+                               .mmap_size = 0,
+                               .cache_size_kib = 2000}},
+    PragmaProfile{"wal_normal", {.journal_mode = "WAL",
+                                 .synchronous = "NORMAL",
+                                 .mmap_size = 0,
+                                 .cache_size_kib = 2000}},
+    PragmaProfile{"wal_normal_mmap", DatabasePragmas{}},
+};
+
+}  // namespace
+
+// Latency of one addVideo commit, which includes its formats
+static void BM_AddVideoCommit(benchmark::State& state) {
+    const PragmaProfile& profile = kPragmaProfiles.at(state.range(0));
+    state.SetLabel(profile.name);
+
+    QTemporaryDir dir;
+    const QString connection_name = unique_connection_name("commit");
+    {
+        Database db = Database::get_temp(
+            connection_name, dir.filePath("history.db"), profile.pragmas);
+        if (!db.valid()) {
+            state.SkipWithError("Failed to open database");
+            return;
+        }
+
+        qint64 index = 0;
+        for (auto _ : state) {
+            db.addVideo(make_sample_info(index++));
+        }
+    }
+    QSqlDatabase::removeDatabase(connection_name);
+
+    state.counters["commits"] =
+        benchmark::Counter(static_cast<double>(state.iterations()),
+                           benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_AddVideoCommit)
+    ->ArgName("profile")
+    ->DenseRange(0, kPragmaProfiles.size() - 1)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+
+}  // namespace yd_gui
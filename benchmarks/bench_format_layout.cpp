@@ -0,0 +1,287 @@
+#include <benchmark/benchmark.h>
+#include <database.h>
+#include <qlist.h>
+#include <qsqldatabase.h>
+#include <qsqlquery.h>
+#include <qtemporarydir.h>
+#include <video.h>
+
+#include "_bench_util.h"
+
+using namespace bench_util;  // NOLINT(google-build-using-namespace)
+
+/* Compares the history's packed formats column against its previous layout,
+   one row per format in a formats table. The previous layout is replicated
+   here with the same pragmas, since Database no longer creates it.
+ */
+
+namespace yd_gui {
+
+namespace {
+
+// Prefilled before measuring page loads and database size
+constexpr qint64 kHistoryVideos = 2000;
+
+QList<VideoInfo> make_page(qint64& index) {
+    QList<VideoInfo> infos;
+    for (qint64 i = 0; i < Database::kChunkSize; ++i) {
+        infos << make_sample_info(index++);
+    }
+    return infos;
+}
+
+class RowLayout {
+   public:
+    explicit RowLayout(const QString& file_name)
+        : connection_name_(unique_connection_name("rows")) {
+        QSqlDatabase db =
+            QSqlDatabase::addDatabase("QSQLITE", connection_name_);
+        db.setDatabaseName(file_name);
+        valid_ = db.open();
+
+        const QList<QString> statements = {
+            "PRAGMA journal_mode = WAL;",
+            "PRAGMA synchronous = NORMAL;",
+            QString("PRAGMA mmap_size = %1;").arg(DatabasePragmas{}.mmap_size),
+            QString("PRAGMA cache_size = %1;")
+                .arg(-DatabasePragmas{}.cache_size_kib),
+
+            "CREATE TABLE videos ("
+            "    id INTEGER PRIMARY KEY AUTOINCREMENT,"
+            "    created_at INTEGER NOT NULL, video_id TEXT NOT NULL,"
+            "    title TEXT NOT NULL, author TEXT NOT NULL,"
+            "    seconds INTEGER NOT NULL, thumbnail TEXT NOT NULL,"
+            "    url TEXT NOT NULL, audio_available BOOLEAN NOT NULL);",
+
+            "CREATE TABLE formats ("
+            "    id INTEGER PRIMARY KEY AUTOINCREMENT,"
+            "    format_id TEXT NOT NULL, container TEXT NOT NULL,"
+            "    width INTEGER NOT NULL, height INTEGER NOT NULL,"
+            "    fps REAL NOT NULL, videos_id INTEGER NOT NULL);",
+
+            "CREATE INDEX formats_videos_id ON formats (videos_id);",
+        };
+        for (const auto& statement : statements) {
+            valid_ = valid_ && QSqlQuery(db).exec(statement);
+        }
+    }
+
+    RowLayout(const RowLayout&) = delete;
+    RowLayout& operator=(const RowLayout&) = delete;
+
+    ~RowLayout() {
+        QSqlDatabase::database(connection_name_).close();
+        QSqlDatabase::removeDatabase(connection_name_);
+    }
+
+    bool valid() const { return valid_; }
+
+    const QString& connection_name() const { return connection_name_; }
+
+    // In one transaction with a row per video and per format
+    bool insert(const QList<VideoInfo>& infos) {
+        QSqlDatabase db = QSqlDatabase::database(connection_name_);
+        if (!db.transaction()) return false;
+
+        QSqlQuery video_query(db);
+        video_query.prepare(
+            "INSERT INTO videos (created_at, video_id, title, author,"
+            "    seconds, thumbnail, url, audio_available) "
+            "VALUES (0, ?, ?, ?, ?, ?, ?, ?);");
+        QSqlQuery format_query(db);
+        format_query.prepare(
+            "INSERT INTO formats (format_id, container, width, height, fps,"
+            "    videos_id) "
+            "VALUES (?, ?, ?, ?, ?, ?);");
+
+        for (const auto& info : infos) {
+            video_query.addBindValue(info.video_id());
+            video_query.addBindValue(info.title());
+            video_query.addBindValue(info.author());
+            video_query.addBindValue(info.seconds());
+            video_query.addBindValue(info.thumbnail());
+            video_query.addBindValue(info.url());
+            video_query.addBindValue(info.audio_available());
+            if (!video_query.exec()) {
+                db.rollback();
+                return false;
+            }
+
+            const qint64 videos_id = video_query.lastInsertId().toLongLong();
+            for (const auto& format : info.formats()) {
+                format_query.addBindValue(format.format_id());
+                format_query.addBindValue(format.container());
+                format_query.addBindValue(format.width());
+                format_query.addBindValue(format.height());
+                format_query.addBindValue(format.fps());
+                format_query.addBindValue(videos_id);
+                if (!format_query.exec()) {
+                    db.rollback();
+                    return false;
+                }
+            }
+        }
+
+        return db.commit();
+    }
+
+    // The newest page, stepping through the formats of each video like
+    // fetch_first_chunk() used to. Returns the number of formats read.
+    qint64 load_page() {
+        QSqlDatabase db = QSqlDatabase::database(connection_name_);
+
+        QSqlQuery video_query(db);
+        video_query.setForwardOnly(true);
+        video_query.prepare(
+            "SELECT id, created_at, video_id, title, author, seconds,"
+            "    thumbnail, url, audio_available "
+            "FROM videos ORDER BY id DESC LIMIT ?;");
+        video_query.addBindValue(Database::kChunkSize);
+        if (!video_query.exec()) return -1;
+
+        QSqlQuery format_query(db);
+        format_query.setForwardOnly(true);
+        format_query.prepare(
+            "SELECT format_id, container, width, height, fps "
+            "FROM formats WHERE videos_id = ? ORDER BY id ASC;");
+
+        qint64 formats = 0;
+        while (video_query.next()) {
+            QList<VideoFormat> video_formats;
+
+            format_query.addBindValue(video_query.value(0));
+            if (!format_query.exec()) return -1;
+            while (format_query.next()) {
+                video_formats << VideoFormat(format_query.value(0).toString(),
+                                             format_query.value(1).toString(),
+                                             format_query.value(2).toUInt(),
+                                             format_query.value(3).toUInt(),
+                                             format_query.value(4).toFloat());
+            }
+
+            const VideoInfo info(
+                video_query.value(2).toString(),
+                video_query.value(3).toString(),
+                video_query.value(4).toString(), video_query.value(5).toUInt(),
+                video_query.value(6).toString(),
+                video_query.value(7).toString(), std::move(video_formats),
+                video_query.value(8).toBool());
+            formats += info.formats().size();
+        }
+        return formats;
+    }
+
+   private:
+    const QString connection_name_;
+    bool valid_ = false;
+};
+
+}  // namespace
+
+// Inserting a page of videos in one transaction
+static void BM_InsertPageRows(benchmark::State& state) {
+    QTemporaryDir dir;
+    RowLayout rows(dir.filePath("rows.db"));
+    if (!rows.valid()) {
+        state.SkipWithError("Failed to open database");
+        return;
+    }
+
+    qint64 index = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        const QList<VideoInfo> infos = make_page(index);
+        state.ResumeTiming();
+
+        if (!rows.insert(infos)) {
+            state.SkipWithError("Failed to insert");
+            return;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * Database::kChunkSize);
+}
+BENCHMARK(BM_InsertPageRows)->Unit(benchmark::kMicrosecond);
+
+static void BM_InsertPagePacked(benchmark::State& state) {
+    QTemporaryDir dir;
+    const QString connection_name = unique_connection_name("packed");
+    {
+        Database db =
+            Database::get_temp(connection_name, dir.filePath("packed.db"));
+        if (!db.valid()) {
+            state.SkipWithError("Failed to open database");
+            return;
+        }
+
+        qint64 index = 0;
+        for (auto _ : state) {
+            state.PauseTiming();
+            const QList<VideoInfo> infos = make_page(index);
+            state.ResumeTiming();
+
+            db.addVideos(infos);
+        }
+    }
+    QSqlDatabase::removeDatabase(connection_name);
+
+    state.SetItemsProcessed(state.iterations() * Database::kChunkSize);
+}
+BENCHMARK(BM_InsertPagePacked)->Unit(benchmark::kMicrosecond);
+
+// Loading the newest page with every video's formats, and the size of a
+// history of kHistoryVideos
+static void BM_LoadPageRows(benchmark::State& state) {
+    QTemporaryDir dir;
+    RowLayout rows(dir.filePath("rows.db"));
+    if (!rows.valid()) {
+        state.SkipWithError("Failed to open database");
+        return;
+    }
+
+    for (qint64 index = 0; index < kHistoryVideos;) {
+        if (!rows.insert(make_page(index))) {
+            state.SkipWithError("Failed to prefill");
+            return;
+        }
+    }
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(rows.load_page());
+    }
+
+    state.counters["bytes_per_video"] =
+        static_cast<double>(database_size(rows.connection_name())) /
+        kHistoryVideos;
+}
+BENCHMARK(BM_LoadPageRows)->Unit(benchmark::kMicrosecond);
+
+// Pages leave the packed formats out, they're read per video instead, see
+// Database::fetch_formats()
+static void BM_LoadPagePacked(benchmark::State& state) {
+    QTemporaryDir dir;
+    const QString connection_name = unique_connection_name("packed");
+    {
+        Database db =
+            Database::get_temp(connection_name, dir.filePath("packed.db"));
+        if (!db.valid()) {
+            state.SkipWithError("Failed to open database");
+            return;
+        }
+
+        for (qint64 index = 0; index < kHistoryVideos;) {
+            db.addVideos(make_page(index));
+        }
+
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(db.fetch_first_chunk());
+        }
+
+        state.counters["bytes_per_video"] =
+            static_cast<double>(database_size(connection_name)) /
+            kHistoryVideos;
+    }
+    QSqlDatabase::removeDatabase(connection_name);
+}
+BENCHMARK(BM_LoadPagePacked)->Unit(benchmark::kMicrosecond);
+
+}  // namespace yd_gui
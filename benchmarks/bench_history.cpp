@@ -0,0 +1,316 @@
+#include <benchmark/benchmark.h>
+#include <database.h>
+#include <qfile.h>
+#include <qlist.h>
+#include <qsqldatabase.h>
+#include <qstring.h>
+#include <qtemporarydir.h>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+
+#include "_bench_util.h"
+
+using namespace bench_util;  // NOLINT(google-build-using-namespace)
+
+namespace yd_gui {
+
+namespace {
+
+// Videos per addVideos() transaction while populating
+constexpr qint64 kPopulateBatch = 10'000;
+
+struct History {
+    QTemporaryDir dir;
+    QString file_name;
+    qint64 size_bytes = 0;
+};
+
+/* Populated once per number of videos and shared by every benchmark of that
+   size, since filling 1M videos takes a while. Benchmarks that write to
+   history work on a copy_history() instead.
+ */
+const History& history_of(const qint64 videos) {
+    static std::map<qint64, std::unique_ptr<History>> histories;
+
+    std::unique_ptr<History>& history = histories[videos];
+    if (history) return *history;
+
+    history = std::make_unique<History>();
+    history->file_name = history->dir.filePath("history.db");
+
+    const QString connection_name = unique_connection_name("populate");
+    {
+        Database db = Database::get_temp(connection_name, history->file_name);
+
+        QList<VideoInfo> infos;
+        for (qint64 begin = 0; begin < videos; begin += kPopulateBatch) {
+            const qint64 end = std::min(begin + kPopulateBatch, videos);
+
+            infos.clear();
+            for (qint64 index = begin; index < end; ++index) {
+                infos << make_sample_info(index);
+            }
+            db.addVideos(infos);
+        }
+
+        // Also leaves the whole history in the main file for copying
+        history->size_bytes = database_size(connection_name);
+    }
+    QSqlDatabase::removeDatabase(connection_name);
+
+    return *history;
+}
+
+QString copy_history(const History& history, const QTemporaryDir& dir) {
+    const QString file_name = dir.filePath("history.db");
+    QFile::copy(history.file_name, file_name);
+    return file_name;
+}
+
+// Export of history_of(videos), written once like the history itself
+const QString& exported_history_of(const qint64 videos) {
+    static std::map<qint64, std::unique_ptr<QTemporaryDir>> dirs;
+    static std::map<qint64, QString> file_names;
+
+    QString& file_name = file_names[videos];
+    if (!file_name.isEmpty()) return file_name;
+
+    const History& history = history_of(videos);
+    std::unique_ptr<QTemporaryDir>& dir = dirs[videos];
+    dir = std::make_unique<QTemporaryDir>();
+
+    const QString connection_name = unique_connection_name("export_once");
+    {
+        Database db = Database::get_temp(connection_name, history.file_name);
+        if (db.export_history(dir->filePath("history.jsonl")).has_value()) {
+            file_name = dir->filePath("history.jsonl");
+        }
+    }
+    QSqlDatabase::removeDatabase(connection_name);
+
+    return file_name;
+}
+
+void history_sizes(benchmark::internal::Benchmark* bench) {
+    bench->ArgName("videos")->Arg(10'000)->Arg(100'000)->Arg(1'000'000);
+}
+
+}  // namespace
+
+// Opening the app, along with the size of the history on disk
+static void BM_HistoryFetchFirstChunk(benchmark::State& state) {
+    const History& history = history_of(state.range(0));
+
+    const QString connection_name = unique_connection_name("first_chunk");
+    {
+        Database db = Database::get_temp(connection_name, history.file_name);
+        if (!db.valid()) {
+            state.SkipWithError("Failed to open database");
+            return;
+        }
+
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(db.fetch_first_chunk());
+        }
+    }
+    QSqlDatabase::removeDatabase(connection_name);
+
+    state.counters["db_bytes"] = static_cast<double>(history.size_bytes);
+    state.counters["bytes_per_video"] =
+        static_cast<double>(history.size_bytes) / state.range(0);
+}
+BENCHMARK(BM_HistoryFetchFirstChunk)
+    ->Apply(history_sizes)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+
+// Scrolling through history, one page per iteration from the newest video to
+// the oldest, starting over once it runs out
+static void BM_HistoryFetchChunkWalk(benchmark::State& state) {
+    const History& history = history_of(state.range(0));
+
+    const QString connection_name = unique_connection_name("chunk_walk");
+    {
+        Database db = Database::get_temp(connection_name, history.file_name);
+        if (!db.valid()) {
+            state.SkipWithError("Failed to open database");
+            return;
+        }
+
+        QList<ManagedVideoParts> chunk = db.fetch_first_chunk();
+        for (auto _ : state) {
+            chunk = chunk.size() < Database::kChunkSize
+                        ? db.fetch_first_chunk()
+                        : db.fetch_chunk(chunk.first().id,
+                                         chunk.first().created_at);
+        }
+    }
+    QSqlDatabase::removeDatabase(connection_name);
+
+    state.SetItemsProcessed(state.iterations() * Database::kChunkSize);
+}
+BENCHMARK(BM_HistoryFetchChunkWalk)
+    ->Apply(history_sizes)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+
+// Fixed iterations keep the history close to its size
+static void BM_HistoryAddVideo(benchmark::State& state) {
+    const qint64 videos = state.range(0);
+
+    QTemporaryDir dir;
+    const QString file_name = copy_history(history_of(videos), dir);
+
+    const QString connection_name = unique_connection_name("add");
+    {
+        Database db = Database::get_temp(connection_name, file_name);
+        if (!db.valid()) {
+            state.SkipWithError("Failed to open database");
+            return;
+        }
+
+        qint64 index = videos;
+        for (auto _ : state) {
+            db.addVideo(make_sample_info(index++));
+        }
+    }
+    QSqlDatabase::removeDatabase(connection_name);
+}
+BENCHMARK(BM_HistoryAddVideo)
+    ->Apply(history_sizes)
+    ->Iterations(1000)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+
+/* Removes the newest videos first, like deleting from the top of the list.
+   Removing only tombstones a video, it's deleted by purgeRemovedVideos()
+   once its undo window has passed, which isn't measured.
+ */
+static void BM_HistoryTombstoneVideo(benchmark::State& state) {
+    const qint64 videos = state.range(0);
+
+    QTemporaryDir dir;
+    const QString file_name = copy_history(history_of(videos), dir);
+
+    const QString connection_name = unique_connection_name("tombstone");
+    {
+        Database db = Database::get_temp(connection_name, file_name);
+        if (!db.valid()) {
+            state.SkipWithError("Failed to open database");
+            return;
+        }
+
+        // Ids were assigned from 1 while populating
+        qint64 id = videos;
+        for (auto _ : state) {
+            db.removeVideo(id--);
+        }
+    }
+    QSqlDatabase::removeDatabase(connection_name);
+}
+BENCHMARK(BM_HistoryTombstoneVideo)
+    ->Apply(history_sizes)
+    ->Iterations(1000)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+
+/* Raising the clear watermark, then every batch deleting the videos behind
+   it. Without a thread of its own the batches run back to back. Only the
+   first clear has anything to remove, hence a single iteration.
+ */
+static void BM_HistoryClear(benchmark::State& state) {
+    QTemporaryDir dir;
+    const QString file_name = copy_history(history_of(state.range(0)), dir);
+
+    const QString connection_name = unique_connection_name("clear");
+    {
+        Database db = Database::get_temp(connection_name, file_name);
+        if (!db.valid()) {
+            state.SkipWithError("Failed to open database");
+            return;
+        }
+
+        for (auto _ : state) {
+            db.removeAllVideos();
+        }
+    }
+    QSqlDatabase::removeDatabase(connection_name);
+}
+BENCHMARK(BM_HistoryClear)
+    ->Apply(history_sizes)
+    ->Iterations(1)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Streamed to a file, so memory stays flat regardless of the history's size
+static void BM_HistoryExport(benchmark::State& state) {
+    const History& history = history_of(state.range(0));
+
+    QTemporaryDir dir;
+    const QString file_name = dir.filePath("history.jsonl");
+
+    const QString connection_name = unique_connection_name("export");
+    {
+        Database db = Database::get_temp(connection_name, history.file_name);
+        if (!db.valid()) {
+            state.SkipWithError("Failed to open database");
+            return;
+        }
+
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(db.export_history(file_name));
+        }
+    }
+    QSqlDatabase::removeDatabase(connection_name);
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_HistoryExport)
+    ->Apply(history_sizes)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Into an empty history each iteration. videos_per_minute is held against
+// the 100k per minute target.
+static void BM_HistoryImport(benchmark::State& state) {
+    const QString& exported = exported_history_of(state.range(0));
+    if (exported.isEmpty()) {
+        state.SkipWithError("Failed to export history");
+        return;
+    }
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        QTemporaryDir dir;
+        const QString connection_name = unique_connection_name("import");
+        {
+            Database db = Database::get_temp(connection_name,
+                                             dir.filePath("history.db"));
+            if (!db.valid()) {
+                state.SkipWithError("Failed to open database");
+                break;
+            }
+            state.ResumeTiming();
+
+            benchmark::DoNotOptimize(db.import_history(exported));
+
+            state.PauseTiming();
+        }
+        QSqlDatabase::removeDatabase(connection_name);
+        state.ResumeTiming();
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["videos_per_minute"] = benchmark::Counter(
+        static_cast<double>(state.iterations() * state.range(0)) * 60,
+        benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_HistoryImport)
+    ->Apply(history_sizes)
+    ->Iterations(1)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}  // namespace yd_gui
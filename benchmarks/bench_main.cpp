@@ -0,0 +1,15 @@
+#include <benchmark/benchmark.h>
+#include <qcoreapplication.h>
+
+// Run with --benchmark_format=json (or --benchmark_out=<file>) for
+// machine-readable results
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
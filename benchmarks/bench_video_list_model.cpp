@@ -0,0 +1,83 @@
+#include <benchmark/benchmark.h>
+#include <database.h>
+#include <qlist.h>
+#include <qsqldatabase.h>
+#include <video_list_model.h>
+
+#include <algorithm>
+#include <memory>
+
+#include "_bench_util.h"
+
+using namespace bench_util;  // NOLINT(google-build-using-namespace)
+
+namespace yd_gui {
+
+namespace {
+
+// Pages from newest to oldest, each from oldest to newest like chunkFetched
+QList<QList<ManagedVideoParts>> make_pages(const qint64 videos,
+                                           const qint64 page_size) {
+    QList<QList<ManagedVideoParts>> pages;
+    for (qint64 end = videos; end > 0; end -= page_size) {
+        const qint64 begin = std::max<qint64>(end - page_size, 0);
+
+        QList<ManagedVideoParts> page;
+        page.reserve(end - begin);
+        for (qint64 index = begin; index < end; ++index) {
+            page << ManagedVideoParts{.id = index + 1,
+                                      .created_at = index,
+                                      .info = make_sample_info(index),
+                                      .state = DownloadState::kComplete};
+        }
+        pages << std::move(page);
+    }
+    return pages;
+}
+
+}  // namespace
+
+/* Scrolling through the whole history, without the database's part. At most
+   VideoListModel::kWindowRows stay loaded, so past the first few pages each
+   prepend also unloads as many of the newest rows.
+ */
+static void BM_ModelPrependPages(benchmark::State& state) {
+    const qint64 videos = state.range(0);
+    const QList<QList<ManagedVideoParts>> pages =
+        make_pages(videos, Database::kChunkSize);
+
+    const QString connection_name = unique_connection_name("model_pages");
+    {
+        Database db = Database::get_temp(connection_name);
+        if (!db.valid()) {
+            state.SkipWithError("Failed to open database");
+            return;
+        }
+
+        for (auto _ : state) {
+            state.PauseTiming();
+            auto model = std::make_unique<VideoListModel>(db);
+            state.ResumeTiming();
+
+            for (const auto& page : pages) {
+                model->prependVideos(page);
+            }
+            state.counters["rows_loaded"] = model->rowCount();
+
+            // Freeing the rows isn't part of loading them
+            state.PauseTiming();
+            model.reset();
+            state.ResumeTiming();
+        }
+    }
+    QSqlDatabase::removeDatabase(connection_name);
+
+    state.SetItemsProcessed(state.iterations() * videos);
+}
+BENCHMARK(BM_ModelPrependPages)
+    ->ArgName("videos")
+    ->Arg(100'000)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}  // namespace yd_gui
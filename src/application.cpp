@@ -13,7 +13,7 @@
 #include <qstringliteral.h>
 
 #include "application_settings.h"
-#include "database.h"
+#include "database_proxy.h"
 
 namespace yd_gui {
 static QGuiApplication* create_application(int& argc, char** argv) {
@@ -50,6 +50,7 @@ static QString get_qt_license() {
 
 Application::Application(int& argc, char** argv)
     : application_(create_application(argc, argv)),
+      database_(new DatabaseProxy),
       engine_(new QQmlApplicationEngine) {
     add_fonts();
 
@@ -57,7 +58,8 @@ Application::Application(int& argc, char** argv)
 
     engine_->rootContext()->setContextProperty("_settings",
                                                &ApplicationSettings::get());
-    engine_->rootContext()->setContextProperty("_database", &Database::get());
+    // Database::get() lives on its own thread, QML only sees it through this
+    engine_->rootContext()->setContextProperty("_database", database_.get());
 
     engine_->rootContext()->setContextProperty("_qt_legal", get_qt_license());
 
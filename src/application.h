@@ -5,6 +5,8 @@
 
 #include <memory>
 
+#include "database_proxy.h"
+
 namespace yd_gui {
 class Application {
    public:
@@ -14,6 +16,7 @@ class Application {
 
    private:
     std::unique_ptr<QGuiApplication> application_;
+    std::unique_ptr<DatabaseProxy> database_;  // outlives engine_
     std::unique_ptr<QQmlApplicationEngine> engine_;
 };
 }  // namespace yd_gui
@@ -131,6 +131,87 @@ QString ApplicationSettings::ffmpegDirStr() const {
     return ffmpegDir().toLocalFile();
 }
 
+static qint64 default_history_max_videos() { return 0; }
+
+qint64 ApplicationSettings::historyMaxVideos() const {
+    return contains("historyMaxVideos") ? value("historyMaxVideos").toLongLong()
+                                        : default_history_max_videos();
+}
+
+void ApplicationSettings::setHistoryMaxVideos(qint64 videos) {
+    const qint64 current_max_videos =
+        value("historyMaxVideos", default_history_max_videos()).toLongLong();
+
+    if (videos == current_max_videos) return;
+
+    setValue("historyMaxVideos", videos);
+    emit historyRetentionChanged();
+}
+
+static qint64 default_history_max_age_days() { return 0; }
+
+qint64 ApplicationSettings::historyMaxAgeDays() const {
+    return contains("historyMaxAgeDays")
+               ? value("historyMaxAgeDays").toLongLong()
+               : default_history_max_age_days();
+}
+
+void ApplicationSettings::setHistoryMaxAgeDays(qint64 days) {
+    const qint64 current_max_age_days =
+        value("historyMaxAgeDays", default_history_max_age_days()).toLongLong();
+
+    if (days == current_max_age_days) return;
+
+    setValue("historyMaxAgeDays", days);
+    emit historyRetentionChanged();
+}
+
+static bool default_history_keep_only_incomplete() { return false; }
+
+// Whether downloaded videos are dropped from history
+bool ApplicationSettings::historyKeepOnlyIncomplete() const {
+    return contains("historyKeepOnlyIncomplete")
+               ? value("historyKeepOnlyIncomplete").toBool()
+               : default_history_keep_only_incomplete();
+}
+
+void ApplicationSettings::setHistoryKeepOnlyIncomplete(bool val) {
+    const bool current_keep_only_incomplete =
+        value("historyKeepOnlyIncomplete",
+              default_history_keep_only_incomplete())
+            .toBool();
+
+    if (val == current_keep_only_incomplete) return;
+
+    setValue("historyKeepOnlyIncomplete", val);
+    emit historyRetentionChanged();
+}
+
+static qint64 default_history_mmap_size() {
+    return static_cast<qint64>(64) * 1024 * 1024;
+}
+
+// In bytes
+qint64 ApplicationSettings::historyMmapSize() const {
+    return contains("historyMmapSize") ? value("historyMmapSize").toLongLong()
+                                       : default_history_mmap_size();
+}
+
+static qint64 default_history_cache_size() { return 8 * 1024; }
+
+// In KiB
+qint64 ApplicationSettings::historyCacheSize() const {
+    return contains("historyCacheSize") ? value("historyCacheSize").toLongLong()
+                                        : default_history_cache_size();
+}
+
+static qint64 default_ui_max_update_rate() { return 60; }
+
+qint64 ApplicationSettings::uiMaxUpdateRate() const {
+    return contains("uiMaxUpdateRate") ? value("uiMaxUpdateRate").toLongLong()
+                                       : default_ui_max_update_rate();
+}
+
 ApplicationSettings::ApplicationSettings(QObject* parent) : QSettings(parent) {}
 
 }  // namespace yd_gui
@@ -3,6 +3,7 @@
 #include <qsettings.h>
 #include <qstring.h>
 #include <qtmetamacros.h>
+#include <qtypes.h>
 #include <qurl.h>
 
 class QObject;
@@ -21,6 +22,13 @@ class ApplicationSettings : public QSettings {
     Q_PROPERTY(QString ytdlpStr READ ytdlpStr NOTIFY ytdlpChanged)
     Q_PROPERTY(QUrl ffmpegDir READ ffmpegDir WRITE setFfmpegDir NOTIFY ffmpegDirChanged)
     Q_PROPERTY(QString ffmpegDirStr READ ffmpegDirStr NOTIFY ffmpegDirChanged)
+    Q_PROPERTY(qint64 historyMaxVideos READ historyMaxVideos WRITE
+                   setHistoryMaxVideos NOTIFY historyRetentionChanged)
+    Q_PROPERTY(qint64 historyMaxAgeDays READ historyMaxAgeDays WRITE
+                   setHistoryMaxAgeDays NOTIFY historyRetentionChanged)
+    Q_PROPERTY(bool historyKeepOnlyIncomplete READ historyKeepOnlyIncomplete
+                   WRITE setHistoryKeepOnlyIncomplete NOTIFY
+                       historyRetentionChanged)
 
    public:
     static ApplicationSettings& get();
@@ -36,6 +44,18 @@ class ApplicationSettings : public QSettings {
     QUrl ffmpegDir() const;
     QString ffmpegDirStr() const;
 
+    // Retention of the history, 0 meaning no limit
+    qint64 historyMaxVideos() const;
+    qint64 historyMaxAgeDays() const;
+    bool historyKeepOnlyIncomplete() const;
+
+    // Advanced history tuning, only configurable through the settings file
+    qint64 historyMmapSize() const;
+    qint64 historyCacheSize() const;
+
+    // Most times per second the list of videos is redrawn for updates
+    qint64 uiMaxUpdateRate() const;
+
    signals:
     void downloadDirChanged();
     void themeChanged();
@@ -43,6 +63,7 @@ class ApplicationSettings : public QSettings {
     void downloadThumbnailChanged();
     void ytdlpChanged();
     void ffmpegDirChanged();
+    void historyRetentionChanged();
 
    public slots:
     void setDownloadDir(const QUrl& dir);
@@ -50,6 +71,9 @@ class ApplicationSettings : public QSettings {
     void setDownloadThumbnail(bool);
     void setYtdlp(const QUrl& ytdlp);
     void setFfmpegDir(const QUrl& ffmpegDir);
+    void setHistoryMaxVideos(qint64 videos);
+    void setHistoryMaxAgeDays(qint64 days);
+    void setHistoryKeepOnlyIncomplete(bool val);
 
    private:
     explicit ApplicationSettings(QObject* parent = nullptr);
@@ -1,458 +1,2373 @@
-#include "database.h"
-
-#include <qcoreapplication.h>
-#include <qdatetime.h>
-#include <qdir.h>
-#include <qobject.h>
-#include <qsqldatabase.h>
-#include <qsqlerror.h>
-#include <qsqlquery.h>
-#include <qstandardpaths.h>
-#include <qtypes.h>
-
-#include <QStringBuilder>
-#include <algorithm>
-#include <optional>
-
-#include "video.h"
-
-namespace yd_gui {
-
-using std::nullopt, std::optional;
-
-Database& Database::get() {
-    static Database db;
-    return db;
-}
-
-// For testing purposes
-Database Database::get_temp(const QString& connection_name) {
-    return Database(":memory:", connection_name);
-}
-
-bool Database::valid() const { return valid_; }
-
-QList<ManagedVideoParts> Database::fetch_first_chunk() {
-    return fetch_chunk_impl(create_select_first_chunk_videos(kChunkSize));
-}
-
-QList<ManagedVideoParts> Database::fetch_chunk(const qint64 last_id,
-                                               const qint64 last_created_at) {
-    return fetch_chunk_impl(
-        create_select_chunk_videos(last_id, last_created_at, kChunkSize));
-}
-
-// Query should be passed from create_select_first_chunk_videos() or
-// create_select_chunk_videos()
-QList<ManagedVideoParts> Database::fetch_chunk_impl(QSqlQuery query) {
-    if (!query.exec()) {
-        log_error("Failed to fetch chunk of history");
-        return {};
-    }
-
-    // videos is currently in the order of newest to oldest
-    auto videos = extract_videos(std::move(query));
-
-    // Must be reversed because it will be PREpended to a model
-    // that has videos from oldest to newest.
-    // i.e., after reversal, videos should now be from oldest to newest.
-    std::reverse(videos.begin(), videos.end());
-
-    return videos;
-}
-
-void Database::setValid(const bool valid) {
-    if (valid == valid_) return;
-    valid_ = valid;
-    emit validChanged(valid_);
-}
-
-// NOLINTNEXTLINE(readability-convert-member-functions-to-static)
-void Database::addVideo(VideoInfo info) {
-    QSqlDatabase db = QSqlDatabase::database(connection_name_);
-    if (!db.transaction()) {
-        log_error("Failed to add video (start add)");
-        log_error(db.lastError().text());
-        return;
-    }
-
-    const qint64 created_at = QDateTime::currentSecsSinceEpoch();
-
-    if (!insert_video(info, created_at)) {
-        db.rollback();
-        return;
-    }
-
-    optional<qint64> opt_videos_id = fetch_last_insert_id();
-    if (!opt_videos_id.has_value()) {
-        db.rollback();
-        return;
-    }
-    qint64 videos_id = opt_videos_id.value();
-
-    for (const auto& format : info.formats()) {
-        if (!insert_format(format, videos_id)) {
-            db.rollback();
-            return;
-        }
-    }
-
-    if (!db.commit()) {
-        log_error("Failed to commit video");
-        db.rollback();
-        return;
-    }
-
-    emit videosPushed({ManagedVideoParts{.id = videos_id,
-                                         .created_at = created_at,
-                                         .info = std::move(info),
-                                         .state = DownloadState::kAdded}});
-}
-
-void Database::removeVideo(const qint64 id) {
-    QSqlQuery query = make_query();
-    if (!query.prepare("DELETE FROM videos "
-                       "WHERE id = :id;")) {
-        log_error("Failed to prepare query for video removal");
-    }
-    query.bindValue(":id", id);
-
-    if (!query.exec()) log_error("Failed to remove video");
-}
-
-void Database::removeAllVideos() {
-    if (!make_query().exec("DELETE FROM videos")) log_error("Failed to clear");
-}
-
-static bool create_videos_table(const QSqlDatabase& db) {
-    QSqlQuery create_videos(db);
-    return create_videos.exec(
-        "CREATE TABLE IF NOT EXISTS videos ("
-        "    id                 INTEGER     PRIMARY KEY AUTOINCREMENT,"
-        "    created_at         INTEGER     NOT NULL,"
-        "    video_id           TEXT        NOT NULL,"
-        "    title              TEXT        NOT NULL,"
-        "    author             TEXT        NOT NULL,"
-        "    seconds            INTEGER     NOT NULL,"
-        "    thumbnail          TEXT        NOT NULL,"
-        "    url                TEXT        NOT NULL,"
-        "    audio_available    BOOLEAN     NOT NULL"
-        ");");
-}
-
-static bool create_formats_table(const QSqlDatabase& db) {
-    QSqlQuery create_formats(db);
-    return create_formats.exec(
-        "CREATE TABLE IF NOT EXISTS formats ("
-        "    id             INTEGER     PRIMARY KEY AUTOINCREMENT,"
-        "    format_id      TEXT        NOT NULL,"
-        "    container      TEXT        NOT NULL,"
-        "    width          INTEGER     NOT NULL,"
-        "    height         INTEGER     NOT NULL,"
-        "    fps            REAL        NOT NULL,"
-        "    videos_id      INTEGER     NOT NULL,"
-        "    FOREIGN KEY (videos_id) REFERENCES videos (id) ON DELETE CASCADE"
-        ");");
-}
-
-bool Database::create_tables() {
-    QSqlDatabase db = make_connection();
-
-    if (!db.transaction()) {
-        log_error("Failed to start creating tables");
-        return false;
-    }
-
-    if (!create_videos_table(db)) {
-        log_error("Failed to create videos table");
-        db.rollback();
-        return false;
-    }
-
-    if (!create_formats_table(db)) {
-        log_error("Failed to create formats table");
-        db.rollback();
-        return false;
-    }
-
-    if (!db.commit()) {
-        log_error("Failed to create tables");
-        return false;
-    }
-
-    qInfo() << "[History] Successfully setup history";
-    return true;
-}
-
-QList<ManagedVideoParts> Database::extract_videos(QSqlQuery videos_query) {
-    QList<ManagedVideoParts> videos;
-    while (videos_query.next()) {
-        bool ok = false;
-
-        const qint64 id = videos_query.value(0).toLongLong(&ok);
-        if (!ok) {
-            log_error("id parse failed");
-            continue;
-        }
-
-        const qint64 created_at = videos_query.value(1).toLongLong(&ok);
-        if (!ok) {
-            log_error("created_at parse failed");
-            continue;
-        }
-
-        QString video_id = videos_query.value(2).toString();
-
-        QString title = videos_query.value(3).toString();
-
-        QString author = videos_query.value(4).toString();
-
-        const quint32 seconds = videos_query.value(5).toUInt(&ok);
-        if (!ok) {
-            log_error("seconds parse failed");
-            continue;
-        }
-
-        QString thumbnail = videos_query.value(6).toString();
-
-        QString url = videos_query.value(7).toString();
-        if (url.isEmpty()) {
-            log_error("url parsed was empty");
-            continue;
-        }
-
-        const bool audio_available = videos_query.value(8).toBool();
-
-        QSqlQuery formats_query = create_select_formats(id);
-
-        ok = formats_query.exec();
-        if (!ok) {
-            log_error("formats fetch failed");
-            continue;
-        }
-
-        auto formats = extract_formats(std::move(formats_query));
-
-        videos << ManagedVideoParts{
-            .id = id,
-            .created_at = created_at,
-            .info =
-                VideoInfo(std::move(video_id), std::move(title),
-                          std::move(author), seconds, std::move(thumbnail),
-                          std::move(url), std::move(formats), audio_available),
-            .state = DownloadState::kComplete};
-    }
-
-    return videos;
-}
-
-QList<VideoFormat> Database::extract_formats(QSqlQuery formats_query) {
-    QList<VideoFormat> formats;
-    while (formats_query.next()) {
-        QString format_id = formats_query.value(0).toString();
-        if (format_id.isEmpty()) {
-            log_error("format_id parsed was empty");
-            continue;
-        }
-
-        QString container = formats_query.value(1).toString();
-
-        bool ok = false;
-        const quint32 width = formats_query.value(2).toUInt(&ok);
-        if (!ok) {
-            log_error("width parse failed");
-            continue;
-        }
-
-        const quint32 height = formats_query.value(3).toUInt(&ok);
-        if (!ok) {
-            log_error("height parse failed");
-            continue;
-        }
-
-        const float fps = formats_query.value(4).toFloat(&ok);
-        if (!ok) {
-            log_error("fps parse failed");
-            continue;
-        }
-
-        formats << VideoFormat(std::move(format_id), std::move(container),
-                               width, height, fps);
-    }
-
-    return formats;
-}
-
-// Selected from newest to oldest
-QSqlQuery Database::create_select_first_chunk_videos(qint64 chunk_size) {
-    QSqlQuery query = make_query();
-    if (!query.prepare("SELECT id, created_at, video_id, title, author,"
-                       "    seconds, thumbnail, url, audio_available "
-                       "FROM videos "
-
-                       "ORDER BY created_at DESC, id DESC "
-
-                       "LIMIT :limit;")) {
-        log_error("Failed to prepare query for select first chunk");
-    }
-    query.bindValue(":limit", chunk_size);
-    query.setForwardOnly(true);
-
-    return query;
-}
-
-// Selected from newest to oldest
-QSqlQuery Database::create_select_chunk_videos(const qint64 last_id,
-                                               const qint64 last_created_at,
-                                               const qint64 chunk_size) {
-    QSqlQuery query = make_query();
-    if (!query.prepare("SELECT id, created_at, video_id, title, author,"
-                       "    seconds, thumbnail, url, audio_available "
-                       "FROM videos "
-
-                       "WHERE (created_at < :last_created_at) "
-                       "OR (created_at = :last_created_at AND id < :last_id) "
-
-                       "ORDER BY created_at DESC, id DESC "
-
-                       "LIMIT :limit;")) {
-        log_error("Failed to prepare query for select chunk");
-    }
-    query.bindValue(":last_id", last_id);
-    query.bindValue(":last_created_at", last_created_at);
-    query.bindValue(":limit", chunk_size);
-    query.setForwardOnly(true);
-
-    return query;
-}
-
-// Selected by oldest to newest
-QSqlQuery Database::create_select_formats(const qint64 videos_id) {
-    QSqlQuery query = make_query();
-    if (!query.prepare("SELECT format_id, container, width, height, fps "
-                       "FROM formats "
-
-                       "WHERE videos_id = :videos_id "
-
-                       "ORDER BY id ASC;")) {
-        log_error("Failed to prepare query for selecting formats");
-    }
-    query.bindValue(":videos_id", videos_id);
-    query.setForwardOnly(true);
-
-    return query;
-}
-
-optional<qint64> Database::fetch_last_insert_id() {
-    QSqlQuery query = make_query();
-
-    if (query.exec("SELECT last_insert_rowid();") && query.next() &&
-        query.value(0).canConvert<qint64>()) {
-        return query.value(0).toLongLong();
-    }
-    log_error("Failed to fetch last insert id");
-
-    return nullopt;
-}
-
-bool Database::insert_video(const VideoInfo& info, const qint64 created_at) {
-    QSqlQuery query = make_query();
-    if (!query.prepare("INSERT INTO videos"
-                       "("
-                       "    created_at, video_id, title, author, seconds,"
-                       "    thumbnail, url, audio_available"
-                       ")"
-
-                       "VALUES"
-                       "("
-                       "    :created_at, :video_id, :title, :author, :seconds,"
-                       "    :thumbnail, :url, :audio_available"
-                       ");")) {
-        log_error("Failed to prepare query for inserting video");
-    }
-    query.bindValue(":created_at", created_at);
-    query.bindValue(":video_id", info.video_id());
-    query.bindValue(":title", info.title());
-    query.bindValue(":author", info.author());
-    query.bindValue(":seconds", info.seconds());
-    query.bindValue(":thumbnail", info.thumbnail());
-    query.bindValue(":url", info.url());
-    query.bindValue(":audio_available", info.audio_available());
-
-    bool ok = query.exec();
-    if (!ok) log_error("Failed to add video");
-
-    return ok;
-}
-
-bool Database::insert_format(const VideoFormat& format,
-                             const qint64 videos_id) {
-    QSqlQuery query = make_query();
-    if (!query.prepare(
-            "INSERT INTO formats"
-            "("
-            "    format_id, container, width, height, fps, videos_id"
-            ")"
-
-            "VALUES"
-            "("
-            "    :format_id, :container, :width, :height, :fps, :videos_id"
-            ");")) {
-        log_error("Failed to prepare query for inserting format");
-    }
-    query.bindValue(":format_id", format.format_id());
-    query.bindValue(":container", format.container());
-    query.bindValue(":width", format.width());
-    query.bindValue(":height", format.height());
-    query.bindValue(":fps", format.fps());
-    query.bindValue(":videos_id", videos_id);
-
-    bool ok = query.exec();
-    if (!ok) log_error("Failed to add format");
-
-    return ok;
-}
-
-QSqlQuery Database::make_query() { return QSqlQuery(make_connection()); }
-
-QSqlDatabase Database::make_connection() {
-    return QSqlDatabase::database(connection_name_);
-}
-
-void Database::log_error(QString message) {
-    emit errorPushed("[History] " % std::move(message) % '\n');
-}
-
-static bool create_database(const QString& file_name,
-                            const QString& connection_name) {
-    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connection_name);
-    if (file_name == ":memory:")
-        db.setDatabaseName(file_name);
-    else {
-        QString app_data_path = QStandardPaths::writableLocation(
-            QStandardPaths::AppLocalDataLocation);
-        QDir().mkpath(app_data_path);
-        db.setDatabaseName(app_data_path % "/" % file_name);
-    }
-
-    if (!db.open()) {
-        qDebug() << "[History] Failed to open history";
-        return false;
-    }
-
-    return true;
-}
-
-Database::Database(const QString& file_name, QString connection_name,
-                   QObject* parent)
-    : QObject(parent),
-      valid_(false),
-      connection_name_(std::move(connection_name)) {
-    valid_ = create_database(file_name, connection_name_);
-    if (!valid_) return;
-
-    QSqlDatabase db = QSqlDatabase::database(connection_name_);
-    valid_ = create_tables();
-}
-
-}  // namespace yd_gui
+#include "database.h"
+
+#include <qcoreapplication.h>
+#include <qdatetime.h>
+#include <qdir.h>
+#include <qfile.h>
+#include <qfiledevice.h>
+#include <qmutex.h>
+#include <qobject.h>
+#include <qsqldatabase.h>
+#include <qsqlerror.h>
+#include <qsqlquery.h>
+#include <qstandardpaths.h>
+#include <qthread.h>
+#include <qthreadpool.h>
+#include <qtypes.h>
+#include <qvariant.h>
+
+#include <QStringBuilder>
+#include <algorithm>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "application_settings.h"
+#include "video.h"
+
+namespace yd_gui {
+
+using nlohmann::json, std::nullopt, std::optional, std::string;
+
+static DatabasePragmas pragmas_from_settings() {
+    const ApplicationSettings& settings = ApplicationSettings::get();
+
+    DatabasePragmas pragmas;
+    pragmas.mmap_size = settings.historyMmapSize();
+    pragmas.cache_size_kib = settings.historyCacheSize();
+    return pragmas;
+}
+
+static HistoryRetention retention_from_settings() {
+    const ApplicationSettings& settings = ApplicationSettings::get();
+
+    HistoryRetention retention;
+    retention.max_videos = settings.historyMaxVideos();
+    retention.max_age_days = settings.historyMaxAgeDays();
+    retention.keep_only_incomplete = settings.historyKeepOnlyIncomplete();
+    return retention;
+}
+
+Database& Database::get() {
+    static Database* const db = [] {
+        auto* const thread = new QThread;
+        thread->setObjectName("History");
+        thread->start();
+
+        auto* const database = new Database(
+            kDatabaseFileName, kDatabaseFileName, pragmas_from_settings(),
+            thread);
+
+        // Close the connection on its own thread before the thread stops
+        QObject::connect(QCoreApplication::instance(),
+                         &QCoreApplication::aboutToQuit,
+                         QCoreApplication::instance(), [database, thread] {
+                             QMetaObject::invokeMethod(
+                                 database, &Database::close,
+                                 Qt::BlockingQueuedConnection);
+                             thread->quit();
+                             thread->wait();
+                         });
+
+        // Queued behind opening, then again whenever the retention changes
+        database->pruneHistory(retention_from_settings());
+        QObject::connect(&ApplicationSettings::get(),
+                         &ApplicationSettings::historyRetentionChanged,
+                         &ApplicationSettings::get(), [database] {
+                             database->pruneHistory(retention_from_settings());
+                         });
+
+        return database;
+    }();
+    return *db;
+}
+
+// For testing purposes. file_name may be an absolute path to back the
+// database with a real file, e.g., for benchmarking.
+Database Database::get_temp(const QString& connection_name,
+                            const QString& file_name,
+                            const DatabasePragmas& pragmas) {
+    return Database(file_name, connection_name, pragmas);
+}
+
+bool Database::valid() const { return valid_; }
+
+// Re-invokes fn on this' thread if called from another thread, e.g., QML on
+// the GUI thread. Returns whether fn was forwarded.
+template <typename Fn>
+bool Database::forward_to_thread(Fn&& fn) {
+    if (QThread::currentThread() == thread()) return false;
+
+    QMetaObject::invokeMethod(this, std::forward<Fn>(fn),
+                              Qt::QueuedConnection);
+    return true;
+}
+
+// Called on this' thread. fn runs on a reader thread when reads are
+// concurrent, otherwise right away.
+template <typename Fn>
+void Database::run_read(Fn&& fn) {
+    if (!concurrent_reads_) {
+        fn();
+        return;
+    }
+
+    read_pool_.start(std::forward<Fn>(fn));
+}
+
+QList<ManagedVideoParts> Database::fetch_first_chunk(
+    const qint64 chunk_size) {
+    return fetch_chunk_impl(create_select_first_chunk_videos(chunk_size));
+}
+
+QList<ManagedVideoParts> Database::fetch_chunk(const qint64 last_id,
+                                               const qint64 last_created_at,
+                                               const qint64 chunk_size) {
+    return fetch_chunk_impl(
+        create_select_chunk_videos(last_id, last_created_at, chunk_size));
+}
+
+/* The page right after (first_created_at, first_id), from oldest to newest.
+   It's appended to a model holding history seeked into, see
+   VideoListModel::seekTo().
+ */
+QList<ManagedVideoParts> Database::fetch_newer_chunk(
+    const qint64 first_id, const qint64 first_created_at,
+    const qint64 chunk_size) {
+    QSqlQuery query = create_select_newer_chunk_videos(
+        first_id, first_created_at, chunk_size);
+    if (!query.exec()) {
+        log_error("Failed to fetch newer chunk of history");
+        return {};
+    }
+
+    return extract_videos(std::move(query));
+}
+
+// Query should be passed from create_select_first_chunk_videos() or
+// create_select_chunk_videos()
+QList<ManagedVideoParts> Database::fetch_chunk_impl(QSqlQuery query) {
+    if (!query.exec()) {
+        log_error("Failed to fetch chunk of history");
+        return {};
+    }
+
+    // videos is currently in the order of newest to oldest
+    auto videos = extract_videos(std::move(query));
+
+    // Must be reversed because it will be PREpended to a model
+    // that has videos from oldest to newest.
+    // i.e., after reversal, videos should now be from oldest to newest.
+    std::reverse(videos.begin(), videos.end());
+
+    return videos;
+}
+
+// Each word becomes a quoted prefix term so user input can't form FTS5
+// syntax. Punctuation is dropped like the tokenizer would. Terms are
+// implicitly AND'ed.
+static QString to_fts_match(QString text) {
+    for (QChar& c : text) {
+        if (!c.isLetterOrNumber()) c = ' ';
+    }
+
+    QList<QString> terms;
+    for (const auto& word : text.split(' ', Qt::SkipEmptyParts)) {
+        terms << '"' % word % "\"*";
+    }
+    return terms.join(' ');
+}
+
+static QString to_like_pattern(QString text) {
+    text.replace('\\', "\\\\").replace('%', "\\%").replace('_', "\\_");
+    return '%' % text.simplified() % '%';
+}
+
+// Matches on title and author, from newest to oldest like the history's
+// pages. Pages are continued by passing the id and created_at of the last
+// video of the previous page.
+QList<ManagedVideoParts> Database::search(const QString& text,
+                                          const qint64 before_id,
+                                          const qint64 before_created_at) {
+    if (text.simplified().isEmpty()) return {};
+    if (fts_available_ && to_fts_match(text).isEmpty()) return {};
+
+    QSqlQuery query =
+        create_search_videos(text, before_id, before_created_at, kChunkSize);
+    if (!query.exec()) {
+        log_error("Failed to search history");
+        return {};
+    }
+
+    return extract_videos(std::move(query));
+}
+
+// Formats are left out of fetched pages and searches, most are never looked
+// at. Returns an empty list if the video doesn't exist.
+QList<VideoFormat> Database::fetch_formats(const qint64 id) {
+    QSqlQuery query = make_read_query();
+    if (!query.prepare("SELECT formats "
+                       "FROM videos "
+                       "WHERE id = :id;")) {
+        log_error("Failed to prepare query for fetching formats");
+    }
+    query.bindValue(":id", id);
+    query.setForwardOnly(true);
+
+    if (!query.exec()) {
+        log_error("Failed to fetch formats");
+        return {};
+    }
+    if (!query.next()) return {};
+
+    return VideoInfo::unpack_formats(query.value(0).toByteArray());
+}
+
+// Queued and downloading videos both stay queued until their download
+// completes or is cancelled, so an interrupted one is resumed too
+QList<ManagedVideoParts> Database::download_queue() {
+    QSqlQuery query = make_read_query();
+    if (!query.prepare(
+            "SELECT videos.id, videos.created_at, videos.video_id,"
+            "    videos.title, videos.author, videos.seconds,"
+            "    videos.thumbnail, videos.url, videos.audio_available,"
+            "    videos.state, videos.progress, videos.selected_format,"
+            "    videos.download_thumbnail "
+            "FROM download_queue "
+            "JOIN videos ON videos.id = download_queue.videos_id "
+
+            "WHERE videos.id > :cleared_up_to "
+            "AND videos.removed_at IS NULL "
+
+            "ORDER BY download_queue.position;")) {
+        log_error("Failed to prepare query for the download queue");
+    }
+    query.bindValue(":cleared_up_to", cleared_up_to_.load());
+    query.setForwardOnly(true);
+
+    if (!query.exec()) {
+        log_error("Failed to fetch the download queue");
+        return {};
+    }
+
+    return extract_videos(std::move(query));
+}
+
+static QList<HistoryStatsGroup> extract_stats_groups(QSqlQuery& query) {
+    QList<HistoryStatsGroup> groups;
+    while (query.next()) {
+        groups << HistoryStatsGroup{.key = query.value(0).toString(),
+                                    .videos = query.value(1).toLongLong(),
+                                    .seconds = query.value(2).toLongLong()};
+    }
+    return groups;
+}
+
+// Read from summary tables that triggers keep up to date, so it costs the
+// same however large the history is
+HistoryStats Database::stats() {
+    HistoryStats stats;
+
+    QSqlQuery query = make_read_query();
+    query.setForwardOnly(true);
+
+    if (!query.exec("SELECT videos, seconds FROM stats_totals;")) {
+        log_error("Failed to fetch history totals");
+        return stats;
+    }
+    if (query.next()) {
+        stats.videos = query.value(0).toLongLong();
+        stats.seconds = query.value(1).toLongLong();
+    }
+
+    if (!query.prepare("SELECT author, videos, seconds "
+                       "FROM stats_authors "
+                       "ORDER BY videos DESC "
+                       "LIMIT :limit;")) {
+        log_error("Failed to prepare query for author stats");
+    }
+    query.bindValue(":limit", kMaxStatsGroups);
+    if (query.exec()) {
+        stats.authors = extract_stats_groups(query);
+    } else {
+        log_error("Failed to fetch author stats");
+    }
+
+    if (!query.prepare("SELECT month, videos, seconds "
+                       "FROM stats_months "
+                       "ORDER BY month DESC "
+                       "LIMIT :limit;")) {
+        log_error("Failed to prepare query for month stats");
+    }
+    query.bindValue(":limit", kMaxStatsGroups);
+    if (query.exec()) {
+        stats.months = extract_stats_groups(query);
+    } else {
+        log_error("Failed to fetch month stats");
+    }
+
+    return stats;
+}
+
+void Database::setValid(const bool valid) {
+    if (valid_.exchange(valid) == valid) return;
+    emit validChanged(valid);
+}
+
+void Database::fetchFirstChunk(const qint64 chunk_size) {
+    if (forward_to_thread([this, chunk_size] { fetchFirstChunk(chunk_size); }))
+        return;
+
+    run_read([this, chunk_size] {
+        emit chunkFetched(fetch_first_chunk(chunk_size));
+    });
+}
+
+void Database::fetchChunk(const qint64 last_id, const qint64 last_created_at,
+                          const qint64 chunk_size) {
+    if (forward_to_thread([this, last_id, last_created_at, chunk_size] {
+            fetchChunk(last_id, last_created_at, chunk_size);
+        }))
+        return;
+
+    run_read([this, last_id, last_created_at, chunk_size] {
+        emit chunkFetched(fetch_chunk(last_id, last_created_at, chunk_size));
+    });
+}
+
+void Database::fetchNewerChunk(const qint64 first_id,
+                               const qint64 first_created_at,
+                               const qint64 chunk_size) {
+    if (forward_to_thread([this, first_id, first_created_at, chunk_size] {
+            fetchNewerChunk(first_id, first_created_at, chunk_size);
+        }))
+        return;
+
+    run_read([this, first_id, first_created_at, chunk_size] {
+        emit newerChunkFetched(
+            fetch_newer_chunk(first_id, first_created_at, chunk_size));
+    });
+}
+
+void Database::searchVideos(QString text, const qint64 before_id,
+                            const qint64 before_created_at) {
+    if (forward_to_thread([this, text, before_id, before_created_at] {
+            searchVideos(text, before_id, before_created_at);
+        }))
+        return;
+
+    run_read([this, text, before_id, before_created_at] {
+        emit searchFetched(text, before_id, before_created_at,
+                           search(text, before_id, before_created_at));
+    });
+}
+
+void Database::fetchFormats(const qint64 id) {
+    if (forward_to_thread([this, id] { fetchFormats(id); })) return;
+
+    run_read([this, id] { emit formatsFetched(id, fetch_formats(id)); });
+}
+
+void Database::fetchStats() {
+    if (forward_to_thread([this] { fetchStats(); })) return;
+
+    run_read([this] { emit statsFetched(stats()); });
+}
+
+void Database::fetchDownloadQueue() {
+    if (forward_to_thread([this] { fetchDownloadQueue(); })) return;
+
+    run_read([this] { emit downloadQueueFetched(download_queue()); });
+}
+
+// Logged in place of the videos changed by an import or a clear, see
+// migrate_history_changes()
+static constexpr auto kLogHistoryReset =
+    "INSERT INTO history_changes (videos_id) VALUES (NULL);";
+
+/* PRAGMA data_version only changes when another connection commits, e.g.,
+   another instance or a CLI tool, so it's cheap to poll. The videos changed
+   since the last check are then read in one snapshot and reported through
+   historyChanged(), or historyReset() if the history was imported or cleared
+   meanwhile. Changes of this connection made in between are reported along
+   with them. Its own changes are already shown, or reported as they're made,
+   e.g., through videosPruned() and historyImported().
+ */
+void Database::checkForChanges() {
+    if (forward_to_thread([this] { checkForChanges(); })) return;
+
+    if (!valid_) return;
+
+    QSqlQuery query = make_query();
+    if (!query.exec("PRAGMA data_version;") || !query.next()) {
+        log_error("Failed to check for changes");
+        return;
+    }
+    const qint64 data_version = query.value(0).toLongLong();
+    query.finish();
+    if (data_version == data_version_) return;
+
+    QSqlDatabase db = make_connection();
+    if (!db.transaction()) {
+        log_error("Failed to start reading changes");
+        return;
+    }
+
+    if (!query.exec("SELECT cleared_up_to FROM history_meta;") ||
+        !query.next()) {
+        log_error("Failed to read how far the history was cleared");
+        db.rollback();
+        return;
+    }
+    const qint64 cleared_up_to =
+        std::max(query.value(0).toLongLong(), cleared_up_to_.load());
+
+    if (!query.exec("SELECT COALESCE(MAX(seq), 0) FROM history_changes;") ||
+        !query.next()) {
+        log_error("Failed to read the last change");
+        db.rollback();
+        return;
+    }
+    const qint64 last_change = query.value(0).toLongLong();
+    query.finish();
+
+    if (!query.prepare("SELECT EXISTS ("
+                       "    SELECT 1 FROM history_changes "
+                       "    WHERE seq > :after AND seq <= :up_to "
+                       "    AND videos_id IS NULL"
+                       ");")) {
+        log_error("Failed to prepare query for history resets");
+    }
+    query.bindValue(":after", last_change_);
+    query.bindValue(":up_to", last_change);
+
+    if (!query.exec() || !query.next()) {
+        log_error("Failed to read history resets");
+        db.rollback();
+        return;
+    }
+    const bool reset = query.value(0).toBool();
+    query.finish();
+
+    // The whole history is read again instead
+    if (reset) {
+        if (!db.commit()) {
+            log_error("Failed to finish reading changes");
+            db.rollback();
+            return;
+        }
+
+        data_version_ = data_version;
+        last_change_ = last_change;
+        cleared_up_to_ = cleared_up_to;
+        trim_changes();
+
+        emit historyReset();
+        return;
+    }
+
+    QSqlQuery shown_query = make_query();
+    if (!shown_query.prepare(
+            "SELECT id, created_at, video_id, title, author,"
+            "    seconds, thumbnail, url, audio_available,"
+            "    state, progress, selected_format,"
+            "    download_thumbnail "
+            "FROM videos "
+
+            "WHERE id IN ("
+            "    SELECT videos_id FROM history_changes "
+            "    WHERE seq > :after AND seq <= :up_to"
+            ") "
+            "AND id > :cleared_up_to AND removed_at IS NULL "
+
+            "ORDER BY created_at, id;")) {
+        log_error("Failed to prepare query for changed videos");
+    }
+    shown_query.bindValue(":after", last_change_);
+    shown_query.bindValue(":up_to", last_change);
+    shown_query.bindValue(":cleared_up_to", cleared_up_to);
+    shown_query.setForwardOnly(true);
+
+    if (!shown_query.exec()) {
+        log_error("Failed to read changed videos");
+        db.rollback();
+        return;
+    }
+    QList<ManagedVideoParts> shown = extract_videos(std::move(shown_query));
+
+    if (!query.prepare("SELECT DISTINCT videos_id FROM history_changes "
+                       "WHERE seq > :after AND seq <= :up_to "
+                       "AND videos_id > :cleared_up_to "
+                       "AND NOT EXISTS ("
+                       "    SELECT 1 FROM videos "
+                       "    WHERE id = videos_id AND removed_at IS NULL"
+                       ");")) {
+        log_error("Failed to prepare query for removed videos");
+    }
+    query.bindValue(":after", last_change_);
+    query.bindValue(":up_to", last_change);
+    query.bindValue(":cleared_up_to", cleared_up_to);
+    query.setForwardOnly(true);
+
+    if (!query.exec()) {
+        log_error("Failed to read removed videos");
+        db.rollback();
+        return;
+    }
+    QList<qint64> removed;
+    while (query.next()) {
+        removed << query.value(0).toLongLong();
+    }
+    query.finish();
+
+    if (!db.commit()) {
+        log_error("Failed to finish reading changes");
+        db.rollback();
+        return;
+    }
+
+    data_version_ = data_version;
+    last_change_ = last_change;
+    cleared_up_to_ = cleared_up_to;
+    trim_changes();
+
+    if (shown.empty() && removed.empty()) return;
+    emit historyChanged(std::move(shown), std::move(removed));
+}
+
+void Database::exportHistory(QString file_name) {
+    if (forward_to_thread([this, file_name] { exportHistory(file_name); }))
+        return;
+
+    run_read([this, file_name] {
+        if (const optional<qint64> videos = export_history(file_name)) {
+            emit historyExported(file_name, *videos);
+        }
+    });
+}
+
+void Database::importHistory(QString file_name) {
+    if (forward_to_thread([this, file_name] { importHistory(file_name); }))
+        return;
+
+    if (const optional<qint64> videos = import_history(file_name)) {
+        emit historyImported(file_name, *videos);
+    }
+}
+
+void Database::addVideo(VideoInfo info) { addVideos({std::move(info)}); }
+
+// Added in a single transaction and pushed as one batch
+void Database::addVideos(QList<VideoInfo> infos) {
+    // Copying is cheap, VideoInfo is made of implicitly shared members
+    if (forward_to_thread([this, infos] { addVideos(infos); })) return;
+    if (infos.empty()) return;
+
+    QSqlDatabase db = make_connection();
+    if (!db.transaction()) {
+        log_error("Failed to add video (start add)");
+        log_error(db.lastError().text());
+        return;
+    }
+
+    const qint64 created_at = QDateTime::currentSecsSinceEpoch();
+
+    // Prepared once for the whole batch
+    QSqlQuery video_query = prepare_insert_video();
+    QSqlQuery hidden_query = prepare_remove_hidden_copy();
+
+    QList<ManagedVideoParts> videos;
+    videos.reserve(infos.size());
+
+    for (auto& info : infos) {
+        if (!remove_hidden_copy(hidden_query, info)) {
+            db.rollback();
+            return;
+        }
+
+        optional<qint64> opt_videos_id =
+            insert_video(video_query, info, created_at);
+        if (!opt_videos_id.has_value()) {
+            db.rollback();
+            return;
+        }
+        const qint64 videos_id = opt_videos_id.value();
+
+        videos << ManagedVideoParts{.id = videos_id,
+                                    .created_at = created_at,
+                                    .info = std::move(info),
+                                    .state = DownloadState::kAdded};
+    }
+
+    if (!db.commit()) {
+        log_error("Failed to commit video");
+        db.rollback();
+        return;
+    }
+
+    emit videosPushed(std::move(videos));
+}
+
+/* Gathers videos arriving within kBatchWindow, e.g., the entries of a
+   playlist fetch, and adds them through addVideos(). The window starts at the
+   first video so a steady stream is still flushed regularly.
+ */
+void Database::addVideoBatched(VideoInfo info) {
+    if (forward_to_thread([this, info] { addVideoBatched(info); })) return;
+
+    pending_infos_ << std::move(info);
+
+    if (pending_infos_.size() >= kMaxBatchSize) {
+        flush_pending_infos();
+    } else if (!batch_timer_.isActive()) {
+        batch_timer_.start();
+    }
+}
+
+void Database::flush_pending_infos() {
+    batch_timer_.stop();
+    addVideos(std::exchange(pending_infos_, {}));
+}
+
+/* Write-behind of videos' downloads. Only the latest of each video is kept
+   until save_timer_ writes them all in one transaction, so the many progress
+   updates of a download cost a write per window at most.
+ */
+void Database::saveDownload(VideoDownload download) {
+    if (forward_to_thread([this, download] { saveDownload(download); })) return;
+
+    pending_downloads_.insert(download.id, std::move(download));
+
+    if (!save_timer_.isActive()) save_timer_.start();
+}
+
+// Writes the downloads waiting on save_timer_ right away, e.g., before closing
+void Database::flushDownloads() {
+    if (forward_to_thread([this] { flushDownloads(); })) return;
+
+    save_timer_.stop();
+    if (pending_downloads_.empty()) return;
+
+    // Kept for the next window if they couldn't be written
+    if (write_downloads(pending_downloads_.values())) {
+        pending_downloads_.clear();
+    }
+}
+
+// A video is marked downloaded when it first completes and unmarked once it's
+// queued again, see pruneHistory()
+bool Database::write_downloads(const QList<VideoDownload>& downloads) {
+    QSqlDatabase db = make_connection();
+    if (!db.transaction()) {
+        log_error("Failed to start saving downloads");
+        return false;
+    }
+
+    QSqlQuery query = make_query();
+    if (!query.prepare("UPDATE videos "
+                       "SET state = :state, progress = :progress,"
+                       "    selected_format = :selected_format,"
+                       "    download_thumbnail = :download_thumbnail,"
+                       "    downloaded_at = CASE WHEN :complete"
+                       "        THEN COALESCE(downloaded_at, :now)"
+                       "        ELSE NULL END "
+                       "WHERE id = :id;")) {
+        log_error("Failed to prepare query for saving downloads");
+    }
+
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    for (const auto& download : downloads) {
+        query.bindValue(":state", static_cast<int>(download.state));
+        query.bindValue(":progress", download.progress);
+        query.bindValue(":selected_format", download.selected_format);
+        query.bindValue(":download_thumbnail", download.download_thumbnail);
+        query.bindValue(":complete",
+                        download.state == DownloadState::kComplete);
+        query.bindValue(":now", now);
+        query.bindValue(":id", download.id);
+
+        // Removed videos are left out by the WHERE
+        if (!query.exec()) {
+            log_error("Failed to save download");
+            db.rollback();
+            return false;
+        }
+    }
+
+    if (!db.commit()) {
+        log_error("Failed to commit downloads");
+        db.rollback();
+        return false;
+    }
+    return true;
+}
+
+// A video queued again keeps its place
+void Database::enqueueDownload(const qint64 id) {
+    if (forward_to_thread([this, id] { enqueueDownload(id); })) return;
+
+    QSqlQuery query = make_query();
+    if (!query.prepare("INSERT OR IGNORE INTO download_queue (videos_id) "
+                       "SELECT id FROM videos WHERE id = :id;")) {
+        log_error("Failed to prepare query for queueing download");
+    }
+    query.bindValue(":id", id);
+
+    if (!query.exec()) log_error("Failed to queue download");
+}
+
+void Database::dequeueDownload(const qint64 id) {
+    if (forward_to_thread([this, id] { dequeueDownload(id); })) return;
+
+    QSqlQuery query = make_query();
+    if (!query.prepare("DELETE FROM download_queue WHERE videos_id = :id;")) {
+        log_error("Failed to prepare query for dequeueing download");
+    }
+    query.bindValue(":id", id);
+
+    if (!query.exec()) log_error("Failed to dequeue download");
+}
+
+/* Only marks the video as removed, which hides it. It can be brought back
+   through restoreVideo() until purgeRemovedVideos() deletes it for good,
+   which happens in batches once it has been removed for kUndoWindow.
+ */
+void Database::removeVideo(const qint64 id) {
+    if (forward_to_thread([this, id] { removeVideo(id); })) return;
+
+    QSqlQuery query = make_query();
+    if (!query.prepare("UPDATE videos "
+                       "SET removed_at = :removed_at "
+                       "WHERE id = :id AND removed_at IS NULL;")) {
+        log_error("Failed to prepare query for video removal");
+    }
+    query.bindValue(":removed_at", QDateTime::currentSecsSinceEpoch());
+    query.bindValue(":id", id);
+
+    if (!query.exec()) {
+        log_error("Failed to remove video");
+        return;
+    }
+
+    if (!purge_timer_.isActive()) purge_timer_.start();
+    emit statsChanged();
+}
+
+// The video is pushed again if it hasn't been purged yet
+void Database::restoreVideo(const qint64 id) {
+    if (forward_to_thread([this, id] { restoreVideo(id); })) return;
+
+    QSqlQuery query = make_query();
+    if (!query.prepare("UPDATE videos "
+                       "SET removed_at = NULL "
+                       "WHERE id = :id AND removed_at IS NOT NULL "
+                       "AND id > :cleared_up_to "
+                       "RETURNING id, created_at, video_id, title, author,"
+                       "    seconds, thumbnail, url, audio_available,"
+                       "    state, progress, selected_format,"
+                       "    download_thumbnail;")) {
+        log_error("Failed to prepare query for video restoration");
+    }
+    query.bindValue(":id", id);
+    query.bindValue(":cleared_up_to", cleared_up_to_.load());
+
+    if (!query.exec()) {
+        log_error("Failed to restore video");
+        return;
+    }
+
+    QList<ManagedVideoParts> videos = extract_videos(std::move(query));
+    if (!videos.empty()) emit videosPushed(std::move(videos));
+}
+
+// Deletes videos removed at least kUndoWindow ago, kRemoveBatchSize per
+// transaction. Checks again later while any removed videos are left.
+void Database::purgeRemovedVideos() {
+    if (forward_to_thread([this] { purgeRemovedVideos(); })) return;
+
+    const qint64 cutoff =
+        QDateTime::currentSecsSinceEpoch() - kUndoWindow.count();
+
+    QSqlQuery query = make_query();
+    if (!query.prepare("DELETE FROM videos "
+                       "WHERE id IN ("
+                       "    SELECT id FROM videos "
+                       "    WHERE removed_at <= :cutoff "
+                       "    LIMIT :limit"
+                       ");")) {
+        log_error("Failed to prepare query for purging removed videos");
+    }
+    query.bindValue(":cutoff", cutoff);
+    query.bindValue(":limit", kRemoveBatchSize);
+
+    if (!query.exec()) {
+        log_error("Failed to purge removed videos");
+        return;
+    }
+    const bool batch_full = query.numRowsAffected() == kRemoveBatchSize;
+    trim_changes();
+
+    if (batch_full) {
+        // Queued behind other work like remove_cleared()
+        if (threaded_) {
+            QMetaObject::invokeMethod(this, &Database::purgeRemovedVideos,
+                                      Qt::QueuedConnection);
+        } else {
+            purgeRemovedVideos();
+        }
+        return;
+    }
+
+    // Removed within the window
+    if (query.exec("SELECT 1 FROM videos "
+                   "WHERE removed_at IS NOT NULL "
+                   "LIMIT 1;") &&
+        query.next()) {
+        purge_timer_.start();
+    }
+}
+
+/* Hides the whole history at once by raising the id reads are filtered on,
+   then removes the hidden videos in batches. That id is persisted so a clear
+   cut short by quitting is resumed on open. Other connections are told to
+   read the history again, see checkForChanges().
+ */
+void Database::removeAllVideos() {
+    if (forward_to_thread([this] { removeAllVideos(); })) return;
+
+    QSqlDatabase db = make_connection();
+    if (!db.transaction()) {
+        log_error("Failed to start clearing");
+        return;
+    }
+
+    QSqlQuery query = make_query();
+    if (!query.exec("UPDATE history_meta "
+                    "SET cleared_up_to = MAX(cleared_up_to,"
+                    "    (SELECT COALESCE(MAX(id), 0) FROM videos)) "
+                    "RETURNING cleared_up_to;") ||
+        !query.next()) {
+        log_error("Failed to clear");
+        db.rollback();
+        return;
+    }
+    const qint64 cleared_up_to = query.value(0).toLongLong();
+    query.finish();
+
+    if (!query.exec(kLogHistoryReset) || !db.commit()) {
+        log_error("Failed to clear");
+        db.rollback();
+        return;
+    }
+    cleared_up_to_ = cleared_up_to;
+
+    clear_pending_ = true;
+    remove_cleared();
+}
+
+void Database::resume_clear() {
+    QSqlQuery query = make_query();
+    if (!query.exec("SELECT cleared_up_to FROM history_meta;") ||
+        !query.next()) {
+        log_error("Failed to read how far the history was cleared");
+        return;
+    }
+    cleared_up_to_ = query.value(0).toLongLong();
+    query.finish();
+
+    clear_pending_ = true;
+    remove_cleared();
+}
+
+// On its own thread, each batch after the first is queued behind whatever
+// else was requested meanwhile, so the history stays responsive
+void Database::remove_cleared() {
+    while (remove_cleared_batch()) {
+        if (threaded_) {
+            QMetaObject::invokeMethod(this, &Database::remove_cleared,
+                                      Qt::QueuedConnection);
+            return;
+        }
+    }
+
+    // The stats count the cleared videos until they're deleted
+    emit statsChanged();
+}
+
+// Returns whether hidden videos may be left
+bool Database::remove_cleared_batch() {
+    QSqlQuery query = make_query();
+    if (!query.prepare("DELETE FROM videos "
+                       "WHERE id IN ("
+                       "    SELECT id FROM videos "
+                       "    WHERE id <= :cleared_up_to "
+                       "    LIMIT :limit"
+                       ");")) {
+        log_error("Failed to prepare query for removing cleared videos");
+    }
+    query.bindValue(":cleared_up_to", cleared_up_to_.load());
+    query.bindValue(":limit", kRemoveBatchSize);
+
+    // Stays pending so videos added meanwhile still replace hidden copies
+    if (!query.exec()) {
+        log_error("Failed to remove cleared videos");
+        return false;
+    }
+
+    clear_pending_ = query.numRowsAffected() == kRemoveBatchSize;
+    return clear_pending_;
+}
+
+/* Removes the videos the retention doesn't keep, kRemoveBatchSize per
+   transaction like clearing, reporting through videosPruned() and
+   pruneProgress(). Called again while pruning, the running prune carries on
+   with the new retention.
+ */
+void Database::pruneHistory(const HistoryRetention retention) {
+    if (forward_to_thread([this, retention] { pruneHistory(retention); }))
+        return;
+
+    if (!valid_ || !start_prune(retention) || pruning_) return;
+
+    pruning_ = true;
+    prune();
+}
+
+// Videos still shown that are older than the prune's bound, or downloaded.
+// Ones queued or downloading are kept until their download is done.
+static constexpr auto kPrunedVideos =
+    "FROM videos "
+    "WHERE removed_at IS NULL "
+    "AND id > (SELECT cleared_up_to FROM history_meta) "
+    "AND id NOT IN (SELECT videos_id FROM download_queue) "
+    "AND ((created_at, id) < (:before_created_at, :before_id) "
+    "    OR (:prune_downloaded AND downloaded_at IS NOT NULL))";
+
+/* Turns both limits into a single (created_at, id) bound, so each batch is a
+   range of the created_at index instead of a walk past the videos kept.
+   Videos added meanwhile are newer, so it holds for the whole prune.
+ */
+bool Database::start_prune(const HistoryRetention& retention) {
+    prune_before_created_at_ = std::numeric_limits<qint64>::min();
+    prune_before_id_ = 0;
+    prune_downloaded_ = retention.keep_only_incomplete;
+
+    if (retention.max_age_days > 0) {
+        prune_before_created_at_ = QDateTime::currentSecsSinceEpoch() -
+                                   retention.max_age_days * 24 * 60 * 60;
+    }
+
+    QSqlQuery query = make_query();
+    if (retention.max_videos > 0) {
+        // Oldest video kept
+        if (!query.prepare("SELECT created_at, id FROM videos "
+                           "WHERE removed_at IS NULL "
+                           "AND id > (SELECT cleared_up_to FROM history_meta) "
+                           "ORDER BY created_at DESC, id DESC "
+                           "LIMIT 1 OFFSET :offset;")) {
+            log_error("Failed to prepare query for the videos kept");
+        }
+        query.bindValue(":offset", retention.max_videos - 1);
+
+        if (!query.exec()) {
+            log_error("Failed to find the videos kept");
+            return false;
+        }
+
+        if (query.next()) {
+            const qint64 created_at = query.value(0).toLongLong();
+            const qint64 id = query.value(1).toLongLong();
+            if (created_at >= prune_before_created_at_) {
+                prune_before_created_at_ = created_at;
+                prune_before_id_ = id;
+            }
+        }
+    }
+
+    if (!query.prepare(QString("SELECT COUNT(*) ") % kPrunedVideos % ";")) {
+        log_error("Failed to prepare query for counting videos to prune");
+    }
+    query.bindValue(":before_created_at", prune_before_created_at_);
+    query.bindValue(":before_id", prune_before_id_);
+    query.bindValue(":prune_downloaded", prune_downloaded_);
+
+    if (!query.exec() || !query.next()) {
+        log_error("Failed to count videos to prune");
+        return false;
+    }
+
+    pruned_ = 0;
+    prune_total_ = query.value(0).toLongLong();
+    return true;
+}
+
+// Batches are queued like remove_cleared()'s so the writer is never held
+// for longer than one
+void Database::prune() {
+    while (prune_batch()) {
+        if (threaded_) {
+            QMetaObject::invokeMethod(this, &Database::prune,
+                                      Qt::QueuedConnection);
+            return;
+        }
+    }
+    pruning_ = false;
+}
+
+// Returns whether videos to prune may be left
+bool Database::prune_batch() {
+    QSqlQuery query = make_query();
+    if (!query.prepare(QString("DELETE FROM videos "
+                               "WHERE id IN (SELECT id ") %
+                       kPrunedVideos % " LIMIT :limit) RETURNING id;")) {
+        log_error("Failed to prepare query for pruning history");
+    }
+    query.bindValue(":before_created_at", prune_before_created_at_);
+    query.bindValue(":before_id", prune_before_id_);
+    query.bindValue(":prune_downloaded", prune_downloaded_);
+    query.bindValue(":limit", kRemoveBatchSize);
+
+    if (!query.exec()) {
+        log_error("Failed to prune history");
+        return false;
+    }
+
+    QList<qint64> ids;
+    while (query.next()) {
+        ids << query.value(0).toLongLong();
+    }
+    query.finish();
+
+    const qint64 affected = ids.size();
+    pruned_ += affected;
+    if (!ids.empty()) emit videosPruned(std::move(ids));
+    trim_changes();
+
+    // Videos downloaded meanwhile may add to the count
+    const bool done = affected < kRemoveBatchSize;
+    prune_total_ = done ? pruned_ : std::max(prune_total_, pruned_);
+    emit pruneProgress(pruned_, prune_total_);
+
+    if (done && pruned_ > 0) {
+        qInfo() << "[History] Pruned" << pruned_ << "videos";
+    }
+    return !done;
+}
+
+static json to_json(const VideoFormat& format) {
+    return {{"format_id", format.format_id().toStdString()},
+            {"container", format.container().toStdString()},
+            {"width", format.width()},
+            {"height", format.height()},
+            {"fps", format.fps()}};
+}
+
+/* Writes the history shown to file_name as JSON Lines, one object per video
+   from oldest to newest. Rows are written as the query steps through them,
+   so the history is never held in memory. Returns how many videos were
+   written.
+ */
+optional<qint64> Database::export_history(const QString& file_name) {
+    QFile file(file_name);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        log_error("Failed to open " % file_name % " for exporting");
+        return nullopt;
+    }
+
+    QSqlQuery query = make_read_query();
+    if (!query.prepare("SELECT created_at, video_id, title, author, seconds,"
+                       "    thumbnail, url, audio_available, formats "
+                       "FROM videos "
+                       "WHERE id > :cleared_up_to AND removed_at IS NULL "
+                       "ORDER BY id;")) {
+        log_error("Failed to prepare query for exporting history");
+    }
+    query.bindValue(":cleared_up_to", cleared_up_to_.load());
+    query.setForwardOnly(true);
+
+    if (!query.exec()) {
+        log_error("Failed to export history");
+        return nullopt;
+    }
+
+    qint64 videos = 0;
+    while (query.next()) {
+        json formats = json::array();
+        for (const auto& format :
+             VideoInfo::unpack_formats(query.value(8).toByteArray())) {
+            formats.push_back(to_json(format));
+        }
+
+        const json video = {
+            {"created_at", query.value(0).toLongLong()},
+            {"video_id", query.value(1).toString().toStdString()},
+            {"title", query.value(2).toString().toStdString()},
+            {"author", query.value(3).toString().toStdString()},
+            {"seconds", query.value(4).toUInt()},
+            {"thumbnail", query.value(5).toString().toStdString()},
+            {"url", query.value(6).toString().toStdString()},
+            {"audio_available", query.value(7).toBool()},
+            {"formats", std::move(formats)}};
+
+        const string line =
+            video.dump(-1, ' ', false, json::error_handler_t::replace) + '\n';
+        if (file.write(line.data(), static_cast<qint64>(line.size())) !=
+            static_cast<qint64>(line.size())) {
+            log_error("Failed to write to " % file_name);
+            return nullopt;
+        }
+        ++videos;
+    }
+
+    // Writes still buffered may fail too, e.g., on a full disk
+    if (!file.flush() || file.error() != QFileDevice::NoError) {
+        log_error("Failed to write to " % file_name);
+        return nullopt;
+    }
+
+    return videos;
+}
+
+struct ExportedVideo {
+    qint64 created_at;
+    VideoInfo info;
+};
+
+// nullopt if the line isn't a video written by export_history()
+static optional<ExportedVideo> parse_exported_video(const QByteArray& line) {
+    const json video = json::parse(line.cbegin(), line.cend(), nullptr, false);
+    if (!video.is_object()) return nullopt;
+
+    const auto text = [&video](const char* key) {
+        return QString::fromStdString(video.at(key).get<string>());
+    };
+
+    // Thrown by missing or mistyped fields
+    try {
+        QList<VideoFormat> formats;
+        for (const auto& format : video.at("formats")) {
+            formats << VideoFormat(
+                QString::fromStdString(format.at("format_id").get<string>()),
+                QString::fromStdString(format.at("container").get<string>()),
+                format.at("width").get<quint32>(),
+                format.at("height").get<quint32>(),
+                format.at("fps").get<float>());
+        }
+
+        VideoInfo info(text("video_id"), text("title"), text("author"),
+                       video.at("seconds").get<quint32>(), text("thumbnail"),
+                       text("url"), std::move(formats),
+                       video.at("audio_available").get<bool>());
+        if (info.url().isEmpty()) return nullopt;
+
+        return ExportedVideo{.created_at = video.at("created_at").get<qint64>(),
+                             .info = std::move(info)};
+    } catch (const json::exception&) {
+        return nullopt;
+    }
+}
+
+// The videos of a transaction of import_history() aren't logged one by one,
+// the batch is logged as a reset of the history when it's committed
+static bool begin_import_batch(QSqlDatabase& db) {
+    return db.transaction() &&
+           QSqlQuery(db).exec("UPDATE history_meta SET log_changes = 0;");
+}
+
+static bool commit_import_batch(QSqlDatabase& db) {
+    return QSqlQuery(db).exec("UPDATE history_meta SET log_changes = 1;") &&
+           QSqlQuery(db).exec(kLogHistoryReset) && db.commit();
+}
+
+/* Adds the videos of a file written by export_history(), kImportBatchSize
+   per transaction. Videos already in history are refreshed rather than
+   duplicated, see prepare_import_video(). Lines that aren't videos are
+   skipped. Returns how many videos were added.
+ */
+optional<qint64> Database::import_history(const QString& file_name) {
+    QFile file(file_name);
+    if (!file.open(QIODevice::ReadOnly)) {
+        log_error("Failed to open " % file_name % " for importing");
+        return nullopt;
+    }
+
+    QSqlDatabase db = make_connection();
+    QSqlQuery video_query = prepare_import_video();
+    QSqlQuery hidden_query = prepare_remove_hidden_copy();
+
+    qint64 videos = 0;
+    qint64 skipped = 0;
+    qint64 batched = 0;  // videos in the open transaction
+
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine();
+        if (line.trimmed().isEmpty()) continue;
+
+        optional<ExportedVideo> video = parse_exported_video(line);
+        if (!video.has_value()) {
+            ++skipped;
+            continue;
+        }
+
+        if (batched == 0 && !begin_import_batch(db)) {
+            log_error("Failed to start importing history");
+            db.rollback();
+            return nullopt;
+        }
+
+        if (!remove_hidden_copy(hidden_query, video->info) ||
+            !insert_video(video_query, video->info, video->created_at)) {
+            db.rollback();
+            return nullopt;
+        }
+        ++videos;
+
+        if (++batched == kImportBatchSize) {
+            if (!commit_import_batch(db)) {
+                log_error("Failed to commit imported history");
+                db.rollback();
+                return nullopt;
+            }
+            batched = 0;
+        }
+    }
+
+    if (batched > 0 && !commit_import_batch(db)) {
+        log_error("Failed to commit imported history");
+        db.rollback();
+        return nullopt;
+    }
+
+    if (skipped > 0) {
+        qInfo() << "[History] Skipped" << skipped << "lines of" << file_name
+                << "that aren't videos";
+    }
+    return videos;
+}
+
+static bool create_videos_table(const QSqlDatabase& db) {
+    QSqlQuery create_videos(db);
+    return create_videos.exec(
+        "CREATE TABLE IF NOT EXISTS videos ("
+        "    id                 INTEGER     PRIMARY KEY AUTOINCREMENT,"
+        "    created_at         INTEGER     NOT NULL,"
+        "    video_id           TEXT        NOT NULL,"
+        "    title              TEXT        NOT NULL,"
+        "    author             TEXT        NOT NULL,"
+        "    seconds            INTEGER     NOT NULL,"
+        "    thumbnail          TEXT        NOT NULL,"
+        "    url                TEXT        NOT NULL,"
+        "    audio_available    BOOLEAN     NOT NULL"
+        ");");
+}
+
+static bool create_formats_table(const QSqlDatabase& db) {
+    QSqlQuery create_formats(db);
+    return create_formats.exec(
+        "CREATE TABLE IF NOT EXISTS formats ("
+        "    id             INTEGER     PRIMARY KEY AUTOINCREMENT,"
+        "    format_id      TEXT        NOT NULL,"
+        "    container      TEXT        NOT NULL,"
+        "    width          INTEGER     NOT NULL,"
+        "    height         INTEGER     NOT NULL,"
+        "    fps            REAL        NOT NULL,"
+        "    videos_id      INTEGER     NOT NULL,"
+        "    FOREIGN KEY (videos_id) REFERENCES videos (id) ON DELETE CASCADE"
+        ");");
+}
+
+static bool table_exists(const QSqlDatabase& db, const QString& name) {
+    QSqlQuery query(db);
+    query.prepare(
+        "SELECT 1 FROM sqlite_master "
+        "WHERE name = :name;");
+    query.bindValue(":name", name);
+    return query.exec() && query.next();
+}
+
+// External content index over videos' title and author, kept in sync by
+// triggers. Fails if SQLite was built without FTS5.
+static bool create_videos_fts(const QSqlDatabase& db) {
+    const bool existed = table_exists(db, "videos_fts");
+
+    const QList<QString> statements = {
+        "CREATE VIRTUAL TABLE IF NOT EXISTS videos_fts USING fts5("
+        "    title, author,"
+        "    content = 'videos', content_rowid = 'id',"
+        "    tokenize = 'unicode61 remove_diacritics 2'"
+        ");",
+
+        "CREATE TRIGGER IF NOT EXISTS videos_fts_insert "
+        "AFTER INSERT ON videos BEGIN"
+        "    INSERT INTO videos_fts (rowid, title, author)"
+        "    VALUES (new.id, new.title, new.author);"
+        "END;",
+
+        "CREATE TRIGGER IF NOT EXISTS videos_fts_delete "
+        "AFTER DELETE ON videos BEGIN"
+        "    INSERT INTO videos_fts (videos_fts, rowid, title, author)"
+        "    VALUES ('delete', old.id, old.title, old.author);"
+        "END;",
+
+        "CREATE TRIGGER IF NOT EXISTS videos_fts_update "
+        "AFTER UPDATE OF title, author ON videos BEGIN"
+        "    INSERT INTO videos_fts (videos_fts, rowid, title, author)"
+        "    VALUES ('delete', old.id, old.title, old.author);"
+        "    INSERT INTO videos_fts (rowid, title, author)"
+        "    VALUES (new.id, new.title, new.author);"
+        "END;",
+    };
+
+    for (const auto& statement : statements) {
+        if (!QSqlQuery(db).exec(statement)) return false;
+    }
+
+    // Index the history that predates the index
+    return existed ||
+           QSqlQuery(db).exec(
+               "INSERT INTO videos_fts (videos_fts) VALUES ('rebuild');");
+}
+
+/* Removes all but the most recently added row of each video_id, then enforces
+   one row per video_id. Videos without a video_id may repeat.
+ */
+static bool migrate_unique_video_id(const QSqlDatabase& db) {
+    const QList<QString> statements = {
+        "DELETE FROM videos "
+        "WHERE id IN ("
+        "    SELECT id FROM ("
+        "        SELECT id, ROW_NUMBER() OVER ("
+        "            PARTITION BY video_id ORDER BY created_at DESC, id DESC"
+        "        ) AS position "
+        "        FROM videos "
+        "        WHERE video_id <> ''"
+        "    ) "
+        "    WHERE position > 1"
+        ");",
+
+        // Formats of removed videos, foreign keys weren't always enforced
+        "DELETE FROM formats "
+        "WHERE videos_id NOT IN (SELECT id FROM videos);",
+
+        "CREATE UNIQUE INDEX IF NOT EXISTS videos_video_id "
+        "ON videos (video_id) WHERE video_id <> '';",
+
+        // Formats are looked up, replaced, and cascaded by their video
+        "CREATE INDEX IF NOT EXISTS formats_videos_id "
+        "ON formats (videos_id);",
+    };
+
+    for (const auto& statement : statements) {
+        if (!QSqlQuery(db).exec(statement)) return false;
+    }
+    return true;
+}
+
+/* Moves the rows of formats into a single column of their video, packed by
+   VideoInfo::pack_formats(), then drops the formats table. Saves stepping
+   through a row per format when loading history.
+ */
+static bool migrate_packed_formats(const QSqlDatabase& db) {
+    if (!QSqlQuery(db).exec("ALTER TABLE videos "
+                            "ADD COLUMN formats BLOB NOT NULL DEFAULT X'';")) {
+        return false;
+    }
+
+    QSqlQuery select_formats(db);
+    select_formats.setForwardOnly(true);
+    if (!select_formats.exec(
+            "SELECT videos_id, format_id, container, width, height, fps "
+            "FROM formats "
+            "ORDER BY videos_id ASC, id ASC;")) {
+        return false;
+    }
+
+    QSqlQuery update_video(db);
+    if (!update_video.prepare("UPDATE videos "
+                              "SET formats = :formats "
+                              "WHERE id = :id;")) {
+        return false;
+    }
+
+    const auto pack = [&update_video](const qint64 videos_id,
+                                      const QList<VideoFormat>& formats) {
+        update_video.bindValue(":formats", VideoInfo::pack_formats(formats));
+        update_video.bindValue(":id", videos_id);
+        return update_video.exec();
+    };
+
+    // Formats are grouped by their video
+    qint64 videos_id = -1;
+    QList<VideoFormat> formats;
+    while (select_formats.next()) {
+        const qint64 next_videos_id = select_formats.value(0).toLongLong();
+        if (next_videos_id != videos_id && !formats.empty()) {
+            if (!pack(videos_id, formats)) return false;
+            formats.clear();
+        }
+        videos_id = next_videos_id;
+
+        formats << VideoFormat(select_formats.value(1).toString(),
+                               select_formats.value(2).toString(),
+                               select_formats.value(3).toUInt(),
+                               select_formats.value(4).toUInt(),
+                               select_formats.value(5).toFloat());
+    }
+    if (!formats.empty() && !pack(videos_id, formats)) return false;
+
+    // A table can't be dropped while a statement is reading it
+    select_formats.finish();
+
+    return QSqlQuery(db).exec("DROP TABLE formats;");
+}
+
+// Pages are walked by (created_at, id). The index holds the rowid, i.e., id,
+// after created_at so it covers both.
+static bool migrate_created_at_index(const QSqlDatabase& db) {
+    return QSqlQuery(db).exec(
+        "CREATE INDEX IF NOT EXISTS videos_created_at "
+        "ON videos (created_at);");
+}
+
+/* Keeps running totals of videos and seconds, overall, per author and per
+   month, so they don't need a scan of the history. Groups are removed once
+   they are empty.
+ */
+static bool migrate_history_stats(const QSqlDatabase& db) {
+    // In UTC so a video is uncounted from the same month it was counted under
+    const auto month_of = [](const QString& row) -> QString {
+        return "strftime('%Y-%m', " % row % ".created_at, 'unixepoch')";
+    };
+    const QString new_month = month_of("new");
+    const QString old_month = month_of("old");
+
+    const QList<QString> statements = {
+        "CREATE TABLE stats_totals ("
+        "    id      INTEGER PRIMARY KEY CHECK (id = 0),"
+        "    videos  INTEGER NOT NULL,"
+        "    seconds INTEGER NOT NULL"
+        ");",
+
+        "CREATE TABLE stats_authors ("
+        "    author  TEXT    PRIMARY KEY,"
+        "    videos  INTEGER NOT NULL,"
+        "    seconds INTEGER NOT NULL"
+        ") WITHOUT ROWID;",
+
+        "CREATE INDEX stats_authors_videos ON stats_authors (videos);",
+
+        "CREATE TABLE stats_months ("
+        "    month   TEXT    PRIMARY KEY,"
+        "    videos  INTEGER NOT NULL,"
+        "    seconds INTEGER NOT NULL"
+        ") WITHOUT ROWID;",
+
+        // Count the history that predates the tables
+        "INSERT INTO stats_totals (id, videos, seconds) "
+        "SELECT 0, COUNT(*), COALESCE(SUM(seconds), 0) FROM videos;",
+
+        "INSERT INTO stats_authors (author, videos, seconds) "
+        "SELECT author, COUNT(*), SUM(seconds) FROM videos GROUP BY author;",
+
+        "INSERT INTO stats_months (month, videos, seconds) "
+        "SELECT " % month_of("videos") % ", COUNT(*), SUM(seconds) "
+        "FROM videos GROUP BY 1;",
+
+        "CREATE TRIGGER stats_insert AFTER INSERT ON videos BEGIN"
+        "    UPDATE stats_totals"
+        "    SET videos = videos + 1, seconds = seconds + new.seconds;"
+
+        "    INSERT OR IGNORE INTO stats_authors VALUES (new.author, 0, 0);"
+        "    UPDATE stats_authors"
+        "    SET videos = videos + 1, seconds = seconds + new.seconds"
+        "    WHERE author = new.author;"
+
+        "    INSERT OR IGNORE INTO stats_months"
+        "    VALUES (" % new_month % ", 0, 0);"
+        "    UPDATE stats_months"
+        "    SET videos = videos + 1, seconds = seconds + new.seconds"
+        "    WHERE month = " % new_month % ";"
+        "END;",
+
+        "CREATE TRIGGER stats_delete AFTER DELETE ON videos BEGIN"
+        "    UPDATE stats_totals"
+        "    SET videos = videos - 1, seconds = seconds - old.seconds;"
+
+        "    UPDATE stats_authors"
+        "    SET videos = videos - 1, seconds = seconds - old.seconds"
+        "    WHERE author = old.author;"
+        "    DELETE FROM stats_authors"
+        "    WHERE author = old.author AND videos = 0;"
+
+        "    UPDATE stats_months"
+        "    SET videos = videos - 1, seconds = seconds - old.seconds"
+        "    WHERE month = " % old_month % ";"
+        "    DELETE FROM stats_months"
+        "    WHERE month = " % old_month % " AND videos = 0;"
+        "END;",
+
+        // Upserts refresh a video's metadata and bump its created_at
+        "CREATE TRIGGER stats_update "
+        "AFTER UPDATE OF created_at, author, seconds ON videos BEGIN"
+        "    UPDATE stats_totals"
+        "    SET seconds = seconds - old.seconds + new.seconds;"
+
+        "    UPDATE stats_authors"
+        "    SET videos = videos - 1, seconds = seconds - old.seconds"
+        "    WHERE author = old.author;"
+        "    DELETE FROM stats_authors"
+        "    WHERE author = old.author AND videos = 0;"
+        "    INSERT OR IGNORE INTO stats_authors VALUES (new.author, 0, 0);"
+        "    UPDATE stats_authors"
+        "    SET videos = videos + 1, seconds = seconds + new.seconds"
+        "    WHERE author = new.author;"
+
+        "    UPDATE stats_months"
+        "    SET videos = videos - 1, seconds = seconds - old.seconds"
+        "    WHERE month = " % old_month % ";"
+        "    DELETE FROM stats_months"
+        "    WHERE month = " % old_month % " AND videos = 0;"
+        "    INSERT OR IGNORE INTO stats_months"
+        "    VALUES (" % new_month % ", 0, 0);"
+        "    UPDATE stats_months"
+        "    SET videos = videos + 1, seconds = seconds + new.seconds"
+        "    WHERE month = " % new_month % ";"
+        "END;",
+    };
+
+    for (const auto& statement : statements) {
+        if (!QSqlQuery(db).exec(statement)) return false;
+    }
+    return true;
+}
+
+// Single row of state about the history as a whole
+static bool migrate_history_meta(const QSqlDatabase& db) {
+    return QSqlQuery(db).exec(
+               "CREATE TABLE history_meta ("
+               "    id            INTEGER PRIMARY KEY CHECK (id = 0),"
+               "    cleared_up_to INTEGER NOT NULL"
+               ");") &&
+           QSqlQuery(db).exec(
+               "INSERT INTO history_meta (id, cleared_up_to) VALUES (0, 0);");
+}
+
+/* Statements of a trigger body that add (sign "+") or subtract (sign "-") a
+   row of videos to or from the stats, removing groups that become empty
+ */
+static QString stats_delta(const QString& row, const QString& sign) {
+    const QString month =
+        "strftime('%Y-%m', " % row % ".created_at, 'unixepoch')";
+    const QString count = QString("videos = videos %1 1, "
+                                  "seconds = seconds %1 %2.seconds")
+                              .arg(sign)
+                              .arg(row);
+
+    return "UPDATE stats_totals SET " % count % ";"
+
+           "INSERT OR IGNORE INTO stats_authors VALUES (" % row %
+           ".author, 0, 0);"
+           "UPDATE stats_authors SET " % count % " WHERE author = " % row %
+           ".author;"
+           "DELETE FROM stats_authors WHERE author = " % row %
+           ".author AND videos = 0;"
+
+           "INSERT OR IGNORE INTO stats_months VALUES (" % month % ", 0, 0);"
+           "UPDATE stats_months SET " % count % " WHERE month = " % month %
+           ";"
+           "DELETE FROM stats_months WHERE month = " % month %
+           " AND videos = 0;";
+}
+
+/* Removed videos are kept as tombstones until they are purged. The stats
+   triggers are redone so a tombstone is uncounted when it's made, counted
+   again if it's restored, and not uncounted twice when it's purged.
+ */
+static bool migrate_tombstones(const QSqlDatabase& db) {
+    const QList<QString> statements = {
+        "ALTER TABLE videos ADD COLUMN removed_at INTEGER;",
+
+        "CREATE INDEX videos_removed_at ON videos (removed_at) "
+        "WHERE removed_at IS NOT NULL;",
+
+        "DROP TRIGGER stats_insert;",
+        "DROP TRIGGER stats_delete;",
+        "DROP TRIGGER stats_update;",
+
+        "CREATE TRIGGER stats_insert AFTER INSERT ON videos "
+        "WHEN new.removed_at IS NULL BEGIN " %
+            stats_delta("new", "+") % " END;",
+
+        "CREATE TRIGGER stats_delete AFTER DELETE ON videos "
+        "WHEN old.removed_at IS NULL BEGIN " %
+            stats_delta("old", "-") % " END;",
+
+        // Both fire on upserts, removals and restorations
+        "CREATE TRIGGER stats_update_old "
+        "AFTER UPDATE OF created_at, author, seconds, removed_at ON videos "
+        "WHEN old.removed_at IS NULL BEGIN " %
+            stats_delta("old", "-") % " END;",
+
+        "CREATE TRIGGER stats_update_new "
+        "AFTER UPDATE OF created_at, author, seconds, removed_at ON videos "
+        "WHEN new.removed_at IS NULL BEGIN " %
+            stats_delta("new", "+") % " END;",
+    };
+
+    for (const auto& statement : statements) {
+        if (!QSqlQuery(db).exec(statement)) return false;
+    }
+    return true;
+}
+
+// When a video was last downloaded, so retention can keep only incomplete ones
+static bool migrate_downloaded_at(const QSqlDatabase& db) {
+    return QSqlQuery(db).exec(
+               "ALTER TABLE videos ADD COLUMN downloaded_at INTEGER;") &&
+           QSqlQuery(db).exec(
+               "CREATE INDEX videos_downloaded_at ON videos (downloaded_at) "
+               "WHERE downloaded_at IS NOT NULL;");
+}
+
+/* Keeps videos' downloads, see Database::saveDownload(). Videos from before
+   were all shown as downloaded, so they stay that way.
+ */
+static bool migrate_download_state(const QSqlDatabase& db) {
+    const QList<QString> statements = {
+        "ALTER TABLE videos ADD COLUMN state INTEGER NOT NULL DEFAULT 0;",
+        "ALTER TABLE videos ADD COLUMN progress REAL NOT NULL DEFAULT 0;",
+        "ALTER TABLE videos ADD COLUMN selected_format TEXT;",
+        "ALTER TABLE videos ADD COLUMN download_thumbnail BOOLEAN;",
+
+        QString("UPDATE videos SET state = %1;")
+            .arg(static_cast<int>(DownloadState::kComplete)),
+    };
+
+    for (const auto& statement : statements) {
+        if (!QSqlQuery(db).exec(statement)) return false;
+    }
+    return true;
+}
+
+// Downloads left when the app quits, by the order they were queued in
+static bool migrate_download_queue(const QSqlDatabase& db) {
+    return QSqlQuery(db).exec(
+        "CREATE TABLE download_queue ("
+        "    position   INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "    videos_id  INTEGER NOT NULL UNIQUE"
+        "               REFERENCES videos (id) ON DELETE CASCADE"
+        ");");
+}
+
+/* Logs which videos were changed so other connections can pick them up, see
+   Database::checkForChanges(). Download state isn't logged, it's only ever
+   changed by the instance downloading. Neither are videos deleted by purges,
+   they were logged when they were removed. Imports and clears log a single
+   reset, a NULL videos_id, in place of their videos, imports by turning
+   logging off through history_meta. Old changes are dropped by changed_at.
+ */
+static bool migrate_history_changes(const QSqlDatabase& db) {
+    const QList<QString> statements = {
+        "CREATE TABLE history_changes ("
+        "    seq         INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "    videos_id   INTEGER,"
+        "    changed_at  INTEGER NOT NULL"
+        "                DEFAULT (CAST(strftime('%s', 'now') AS INTEGER))"
+        ");",
+
+        "CREATE INDEX history_changes_changed_at "
+        "ON history_changes (changed_at);",
+
+        "ALTER TABLE history_meta "
+        "ADD COLUMN log_changes BOOLEAN NOT NULL DEFAULT 1;",
+
+        "CREATE TRIGGER history_changes_insert AFTER INSERT ON videos "
+        "WHEN (SELECT log_changes FROM history_meta) BEGIN"
+        "    INSERT INTO history_changes (videos_id) VALUES (new.id);"
+        "END;",
+
+        "CREATE TRIGGER history_changes_update "
+        "AFTER UPDATE OF created_at, title, author, seconds, thumbnail, url,"
+        "    removed_at ON videos "
+        "WHEN (SELECT log_changes FROM history_meta) BEGIN"
+        "    INSERT INTO history_changes (videos_id) VALUES (new.id);"
+        "END;",
+
+        // Videos hidden by a clear were logged by its reset
+        "CREATE TRIGGER history_changes_delete AFTER DELETE ON videos "
+        "WHEN old.removed_at IS NULL "
+        "AND old.id > (SELECT cleared_up_to FROM history_meta) "
+        "AND (SELECT log_changes FROM history_meta) BEGIN"
+        "    INSERT INTO history_changes (videos_id) VALUES (old.id);"
+        "END;",
+    };
+
+    for (const auto& statement : statements) {
+        if (!QSqlQuery(db).exec(statement)) return false;
+    }
+    return true;
+}
+
+// Upgrades the schema to the latest version, tracked by user_version. Each
+// migration upgrades from the version equal to its index.
+static bool migrate(const QSqlDatabase& db) {
+    using Migration = bool (*)(const QSqlDatabase&);
+    static const QList<Migration> kMigrations = {
+        migrate_unique_video_id,
+        migrate_packed_formats,
+        migrate_created_at_index,
+        migrate_history_stats,
+        migrate_history_meta,
+        migrate_tombstones,
+        migrate_downloaded_at,
+        migrate_download_state,
+        migrate_download_queue,
+        migrate_history_changes,
+    };
+
+    QSqlQuery query(db);
+    if (!query.exec("PRAGMA user_version;") || !query.next()) return false;
+    const qsizetype from_version = query.value(0).toLongLong();
+
+    // The schema from before it was versioned, which new history starts from
+    if (from_version == 0 &&
+        !(create_videos_table(db) && create_formats_table(db))) {
+        return false;
+    }
+
+    qsizetype version = from_version;
+    for (; version < kMigrations.size(); ++version) {
+        if (!kMigrations[version](db)) {
+            qDebug() << "[History] Failed to migrate from version" << version;
+            return false;
+        }
+    }
+
+    if (version == from_version) return true;
+    return QSqlQuery(db).exec(
+        QString("PRAGMA user_version = %1;").arg(version));
+}
+
+bool Database::create_tables() {
+    QSqlDatabase db = make_connection();
+
+    if (!db.transaction()) {
+        log_error("Failed to start creating tables");
+        return false;
+    }
+
+    if (!migrate(db)) {
+        log_error("Failed to migrate history");
+        db.rollback();
+        return false;
+    }
+
+    fts_available_ = create_videos_fts(db);
+    if (!fts_available_) {
+        qInfo() << "[History] Full-text search unavailable, searching "
+                   "without an index";
+    }
+
+    if (!db.commit()) {
+        log_error("Failed to create tables");
+        return false;
+    }
+
+    qInfo() << "[History] Successfully setup history";
+    return true;
+}
+
+// A download that was queued or running when the app quit was interrupted,
+// it's left with its progress
+static DownloadState to_loaded_state(const DownloadState state) {
+    return state == DownloadState::kComplete ? DownloadState::kComplete
+                                             : DownloadState::kAdded;
+}
+
+QList<ManagedVideoParts> Database::extract_videos(QSqlQuery videos_query) {
+    QList<ManagedVideoParts> videos;
+    while (videos_query.next()) {
+        bool ok = false;
+
+        const qint64 id = videos_query.value(0).toLongLong(&ok);
+        if (!ok) {
+            log_error("id parse failed");
+            continue;
+        }
+
+        const qint64 created_at = videos_query.value(1).toLongLong(&ok);
+        if (!ok) {
+            log_error("created_at parse failed");
+            continue;
+        }
+
+        QString video_id = videos_query.value(2).toString();
+
+        QString title = videos_query.value(3).toString();
+
+        QString author = videos_query.value(4).toString();
+
+        const quint32 seconds = videos_query.value(5).toUInt(&ok);
+        if (!ok) {
+            log_error("seconds parse failed");
+            continue;
+        }
+
+        QString thumbnail = videos_query.value(6).toString();
+
+        QString url = videos_query.value(7).toString();
+        if (url.isEmpty()) {
+            log_error("url parsed was empty");
+            continue;
+        }
+
+        const bool audio_available = videos_query.value(8).toBool();
+
+        const int state = videos_query.value(9).toInt(&ok);
+        if (!ok || state < static_cast<int>(DownloadState::kAdded) ||
+            state > static_cast<int>(DownloadState::kComplete)) {
+            log_error("state parse failed");
+            continue;
+        }
+
+        const float progress = videos_query.value(10).toFloat();
+
+        QString selected_format = videos_query.value(11).toString();
+
+        const QVariant download_thumbnail = videos_query.value(12);
+
+        videos << ManagedVideoParts{
+            .id = id,
+            .created_at = created_at,
+            .info = VideoInfo(std::move(video_id), std::move(title),
+                              std::move(author), seconds, std::move(thumbnail),
+                              std::move(url), {}, audio_available),
+            .state = to_loaded_state(static_cast<DownloadState>(state)),
+            .formats_loaded = false,
+            .progress = progress,
+            .selected_format = std::move(selected_format),
+            .download_thumbnail =
+                download_thumbnail.isNull()
+                    ? nullopt
+                    : optional<bool>(download_thumbnail.toBool())};
+    }
+
+    return videos;
+}
+
+// Selected from newest to oldest
+QSqlQuery Database::create_select_first_chunk_videos(qint64 chunk_size) {
+    QSqlQuery query = make_read_query();
+    if (!query.prepare("SELECT id, created_at, video_id, title, author,"
+                       "    seconds, thumbnail, url, audio_available,"
+                       "    state, progress, selected_format,"
+                       "    download_thumbnail "
+                       "FROM videos "
+
+                       "WHERE id > :cleared_up_to AND removed_at IS NULL "
+
+                       "ORDER BY created_at DESC, id DESC "
+
+                       "LIMIT :limit;")) {
+        log_error("Failed to prepare query for select first chunk");
+    }
+    query.bindValue(":cleared_up_to", cleared_up_to_.load());
+    query.bindValue(":limit", chunk_size);
+    query.setForwardOnly(true);
+
+    return query;
+}
+
+// Selected from newest to oldest
+QSqlQuery Database::create_select_chunk_videos(const qint64 last_id,
+                                               const qint64 last_created_at,
+                                               const qint64 chunk_size) {
+    QSqlQuery query = make_read_query();
+    if (!query.prepare("SELECT id, created_at, video_id, title, author,"
+                       "    seconds, thumbnail, url, audio_available,"
+                       "    state, progress, selected_format,"
+                       "    download_thumbnail "
+                       "FROM videos "
+
+                       "WHERE id > :cleared_up_to AND removed_at IS NULL "
+                       "AND ((created_at < :last_created_at) "
+                       "OR (created_at = :last_created_at AND id < :last_id)) "
+
+                       "ORDER BY created_at DESC, id DESC "
+
+                       "LIMIT :limit;")) {
+        log_error("Failed to prepare query for select chunk");
+    }
+    query.bindValue(":last_id", last_id);
+    query.bindValue(":last_created_at", last_created_at);
+    query.bindValue(":cleared_up_to", cleared_up_to_.load());
+    query.bindValue(":limit", chunk_size);
+    query.setForwardOnly(true);
+
+    return query;
+}
+
+// Selected from oldest to newest, the same keyset as
+// create_select_chunk_videos() the other way
+QSqlQuery Database::create_select_newer_chunk_videos(
+    const qint64 first_id, const qint64 first_created_at,
+    const qint64 chunk_size) {
+    QSqlQuery query = make_read_query();
+    if (!query.prepare("SELECT id, created_at, video_id, title, author,"
+                       "    seconds, thumbnail, url, audio_available,"
+                       "    state, progress, selected_format,"
+                       "    download_thumbnail "
+                       "FROM videos "
+
+                       "WHERE id > :cleared_up_to AND removed_at IS NULL "
+                       "AND ((created_at > :first_created_at) "
+                       "OR (created_at = :first_created_at "
+                       "AND id > :first_id)) "
+
+                       "ORDER BY created_at, id "
+
+                       "LIMIT :limit;")) {
+        log_error("Failed to prepare query for select newer chunk");
+    }
+    query.bindValue(":first_id", first_id);
+    query.bindValue(":first_created_at", first_created_at);
+    query.bindValue(":cleared_up_to", cleared_up_to_.load());
+    query.bindValue(":limit", chunk_size);
+    query.setForwardOnly(true);
+
+    return query;
+}
+
+// Selected from newest to oldest, the same keyset as
+// create_select_chunk_videos()
+QSqlQuery Database::create_search_videos(const QString& text,
+                                         const qint64 before_id,
+                                         const qint64 before_created_at,
+                                         const qint64 chunk_size) {
+    QSqlQuery query = make_read_query();
+
+    if (fts_available_) {
+        if (!query.prepare(
+                "SELECT videos.id, videos.created_at, videos.video_id,"
+                "    videos.title, videos.author, videos.seconds,"
+                "    videos.thumbnail, videos.url, videos.audio_available,"
+                "    videos.state, videos.progress, videos.selected_format,"
+                "    videos.download_thumbnail "
+                "FROM videos_fts "
+                "JOIN videos ON videos.id = videos_fts.rowid "
+
+                "WHERE videos_fts MATCH :match "
+                "AND videos_fts.rowid > :cleared_up_to "
+                "AND videos.removed_at IS NULL "
+                "AND ((videos.created_at < :before_created_at) "
+                "OR (videos.created_at = :before_created_at "
+                "AND videos.id < :before_id)) "
+
+                "ORDER BY videos.created_at DESC, videos.id DESC "
+
+                "LIMIT :limit;")) {
+            log_error("Failed to prepare query for search");
+        }
+        query.bindValue(":match", to_fts_match(text));
+    } else {
+        if (!query.prepare("SELECT id, created_at, video_id, title, author,"
+                           "    seconds, thumbnail, url, audio_available,"
+                           "    state, progress, selected_format,"
+                           "    download_thumbnail "
+                           "FROM videos "
+
+                           "WHERE (title LIKE :pattern ESCAPE '\\' "
+                           "OR author LIKE :pattern ESCAPE '\\') "
+                           "AND id > :cleared_up_to AND removed_at IS NULL "
+                           "AND ((created_at < :before_created_at) "
+                           "OR (created_at = :before_created_at "
+                           "AND id < :before_id)) "
+
+                           "ORDER BY created_at DESC, id DESC "
+
+                           "LIMIT :limit;")) {
+            log_error("Failed to prepare query for search");
+        }
+        query.bindValue(":pattern", to_like_pattern(text));
+    }
+    query.bindValue(":before_id", before_id);
+    query.bindValue(":before_created_at", before_created_at);
+    query.bindValue(":cleared_up_to", cleared_up_to_.load());
+    query.bindValue(":limit", chunk_size);
+    query.setForwardOnly(true);
+
+    return query;
+}
+
+/* Upserts on video_id. A video that is already in the history keeps its id
+   but has its metadata and formats refreshed and created_at bumped, moving it
+   to the top. Its download starts over like a new video's.
+   Videos without a video_id are always inserted.
+ */
+QSqlQuery Database::prepare_insert_video() {
+    QSqlQuery query = make_query();
+    if (!query.prepare("INSERT INTO videos"
+                       "("
+                       "    created_at, video_id, title, author, seconds,"
+                       "    thumbnail, url, audio_available, formats"
+                       ")"
+
+                       "VALUES"
+                       "("
+                       "    :created_at, :video_id, :title, :author, :seconds,"
+                       "    :thumbnail, :url, :audio_available, :formats"
+                       ")"
+
+                       "ON CONFLICT (video_id) WHERE video_id <> '' "
+                       "DO UPDATE SET"
+                       "    created_at = excluded.created_at,"
+                       "    title = excluded.title,"
+                       "    author = excluded.author,"
+                       "    seconds = excluded.seconds,"
+                       "    thumbnail = excluded.thumbnail,"
+                       "    url = excluded.url,"
+                       "    audio_available = excluded.audio_available,"
+                       "    formats = excluded.formats,"
+                       "    removed_at = NULL,"
+                       "    state = 0,"  // DownloadState::kAdded
+                       "    progress = 0,"
+                       "    selected_format = NULL,"
+                       "    download_thumbnail = NULL,"
+                       "    downloaded_at = NULL "
+
+                       "RETURNING id;")) {
+        log_error("Failed to prepare query for inserting video");
+    }
+
+    return query;
+}
+
+/* Like prepare_insert_video(), but a video that is already in the history
+   only has its metadata and formats refreshed. It keeps its created_at, its
+   download and whether it was removed, which a backup knows nothing of.
+ */
+QSqlQuery Database::prepare_import_video() {
+    QSqlQuery query = make_query();
+    if (!query.prepare("INSERT INTO videos"
+                       "("
+                       "    created_at, video_id, title, author, seconds,"
+                       "    thumbnail, url, audio_available, formats"
+                       ")"
+
+                       "VALUES"
+                       "("
+                       "    :created_at, :video_id, :title, :author, :seconds,"
+                       "    :thumbnail, :url, :audio_available, :formats"
+                       ")"
+
+                       "ON CONFLICT (video_id) WHERE video_id <> '' "
+                       "DO UPDATE SET"
+                       "    title = excluded.title,"
+                       "    author = excluded.author,"
+                       "    seconds = excluded.seconds,"
+                       "    thumbnail = excluded.thumbnail,"
+                       "    url = excluded.url,"
+                       "    audio_available = excluded.audio_available,"
+                       "    formats = excluded.formats "
+
+                       "RETURNING id;")) {
+        log_error("Failed to prepare query for importing video");
+    }
+
+    return query;
+}
+
+// Returns the id of the inserted or updated video
+optional<qint64> Database::insert_video(QSqlQuery& query, const VideoInfo& info,
+                                        const qint64 created_at) {
+    query.bindValue(":created_at", created_at);
+    query.bindValue(":video_id", info.video_id());
+    query.bindValue(":title", info.title());
+    query.bindValue(":author", info.author());
+    query.bindValue(":seconds", info.seconds());
+    query.bindValue(":thumbnail", info.thumbnail());
+    query.bindValue(":url", info.url());
+    query.bindValue(":audio_available", info.audio_available());
+    query.bindValue(":formats", VideoInfo::pack_formats(info.formats()));
+
+    if (!query.exec() || !query.next()) {
+        log_error("Failed to add video");
+        return nullopt;
+    }
+
+    bool ok = false;
+    const qint64 id = query.value(0).toLongLong(&ok);
+    // Let the prepared query be reused
+    query.finish();
+    if (!ok) {
+        log_error("Failed to fetch id of added video");
+        return nullopt;
+    }
+
+    return id;
+}
+
+// A hidden copy would otherwise be upserted and stay hidden, see
+// removeAllVideos()
+QSqlQuery Database::prepare_remove_hidden_copy() {
+    QSqlQuery query = make_query();
+    if (clear_pending_ &&
+        !query.prepare("DELETE FROM videos "
+                       "WHERE video_id = :video_id AND video_id <> '' "
+                       "AND id <= :cleared_up_to;")) {
+        log_error("Failed to prepare query for removing hidden copies");
+    }
+
+    return query;
+}
+
+// Does nothing unless a clear is pending
+bool Database::remove_hidden_copy(QSqlQuery& query, const VideoInfo& info) {
+    if (!clear_pending_) return true;
+
+    query.bindValue(":video_id", info.video_id());
+    query.bindValue(":cleared_up_to", cleared_up_to_.load());
+    if (!query.exec()) {
+        log_error("Failed to remove hidden copy of video");
+        return false;
+    }
+    return true;
+}
+
+QSqlQuery Database::make_query() { return QSqlQuery(make_connection()); }
+
+QSqlDatabase Database::make_connection() {
+    return QSqlDatabase::database(connection_name_);
+}
+
+void Database::log_error(QString message) {
+    emit errorPushed("[History] " % std::move(message) % '\n');
+}
+
+// Pragma failures aren't fatal, the history still works with the defaults
+static void apply_pragmas(const QSqlDatabase& db,
+                          const DatabasePragmas& pragmas) {
+    const QList<QString> statements = {
+        // Set first so switching the journal mode waits out other connections
+        QString("PRAGMA busy_timeout = %1;").arg(pragmas.busy_timeout_ms),
+        QString("PRAGMA journal_mode = %1;").arg(pragmas.journal_mode),
+        QString("PRAGMA synchronous = %1;").arg(pragmas.synchronous),
+        QString("PRAGMA mmap_size = %1;").arg(pragmas.mmap_size),
+        // Negative values are interpreted by SQLite as KiB instead of pages
+        QString("PRAGMA cache_size = %1;").arg(-pragmas.cache_size_kib),
+    };
+
+    for (const auto& statement : statements) {
+        QSqlQuery query(db);
+        if (!query.exec(statement)) {
+            qDebug() << "[History] Failed to apply" << statement
+                     << query.lastError().text();
+        }
+    }
+}
+
+static bool create_database(const QString& file_name,
+                            const QString& connection_name,
+                            const DatabasePragmas& pragmas) {
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connection_name);
+    if (file_name == ":memory:" || QDir::isAbsolutePath(file_name))
+        db.setDatabaseName(file_name);
+    else {
+        QString app_data_path = QStandardPaths::writableLocation(
+            QStandardPaths::AppLocalDataLocation);
+        QDir().mkpath(app_data_path);
+        db.setDatabaseName(app_data_path % "/" % file_name);
+    }
+
+    if (!db.open()) {
+        qDebug() << "[History] Failed to open history";
+        return false;
+    }
+
+    apply_pragmas(db, pragmas);
+
+    // Off by default in SQLite
+    if (!QSqlQuery(db).exec("PRAGMA foreign_keys = ON;")) {
+        qDebug() << "[History] Failed to enforce foreign keys";
+    }
+
+    return true;
+}
+
+QSqlQuery Database::make_read_query() { return QSqlQuery(read_connection()); }
+
+/* Reads on this' thread go through the writer so they see its writes. Other
+   threads get a read-only connection of their own, opened on first use and
+   kept until the history is closed.
+ */
+QSqlDatabase Database::read_connection() {
+    QThread* const current_thread = QThread::currentThread();
+    if (current_thread == thread()) return make_connection();
+
+    const QString name =
+        connection_name_ % "_read_" %
+        QString::number(reinterpret_cast<quintptr>(current_thread), 16);
+    if (QSqlDatabase::contains(name)) {
+        QSqlDatabase db = QSqlDatabase::database(name);
+        if (db.isValid()) return db;
+
+        // Left by a finished thread that had the same address
+        QSqlDatabase::removeDatabase(name);
+    }
+
+    QSqlDatabase db = QSqlDatabase::cloneDatabase(connection_name_, name);
+    {
+        const QMutexLocker lock(&read_connections_mutex_);
+        read_connections_.insert(name);
+    }
+
+    if (!db.open()) {
+        log_error("Failed to open read connection");
+        return db;
+    }
+    apply_pragmas(db, pragmas_);
+    if (!QSqlQuery(db).exec("PRAGMA query_only = ON;")) {
+        qDebug() << "[History] Failed to make read connection read-only";
+    }
+
+    return db;
+}
+
+void Database::open(const QString& file_name,
+                    const DatabasePragmas& pragmas) {
+    setValid(create_database(file_name, connection_name_, pragmas) &&
+             create_tables());
+
+    if (!valid_) return;
+
+    resume_clear();
+    // Left from last time
+    purgeRemovedVideos();
+
+    if (watch_changes()) change_timer_.start();
+}
+
+// Changes are only checked from here on
+bool Database::watch_changes() {
+    if (!trim_changes()) return false;
+
+    QSqlQuery query = make_query();
+    if (!query.exec("SELECT COALESCE(MAX(seq), 0) FROM history_changes;") ||
+        !query.next()) {
+        log_error("Failed to read the last change");
+        return false;
+    }
+    last_change_ = query.value(0).toLongLong();
+
+    if (!query.exec("PRAGMA data_version;") || !query.next()) {
+        log_error("Failed to read the data version");
+        return false;
+    }
+    data_version_ = query.value(0).toLongLong();
+
+    return true;
+}
+
+/* Drops changes old enough that every other connection has checked them.
+   Done on open, whenever changes are checked and after each batch of a prune
+   or purge, so the log stays about kChangesKept long.
+ */
+bool Database::trim_changes() {
+    QSqlQuery query = make_query();
+    if (!query.prepare("DELETE FROM history_changes "
+                       "WHERE changed_at < :cutoff;")) {
+        log_error("Failed to prepare query for dropping old changes");
+    }
+    query.bindValue(":cutoff",
+                    QDateTime::currentSecsSinceEpoch() -
+                        std::chrono::seconds(kChangesKept).count());
+    if (!query.exec()) {
+        log_error("Failed to drop old changes");
+        return false;
+    }
+    return true;
+}
+
+void Database::close() {
+    flushDownloads();
+    close_read_connections();
+
+    make_connection().close();
+    QSqlDatabase::removeDatabase(connection_name_);
+}
+
+// Waits for reads in flight first
+void Database::close_read_connections() {
+    read_pool_.waitForDone();
+
+    const QMutexLocker lock(&read_connections_mutex_);
+    for (const auto& name : std::as_const(read_connections_)) {
+        QSqlDatabase::removeDatabase(name);
+    }
+    read_connections_.clear();
+}
+
+Database::Database(const QString& file_name, QString connection_name,
+                   const DatabasePragmas& pragmas, QThread* const thread,
+                   QObject* parent)
+    : QObject(parent),
+      valid_(false),
+      connection_name_(std::move(connection_name)),
+      pragmas_(pragmas),
+      threaded_(thread != nullptr),
+      // An in-memory history can't be shared between connections
+      concurrent_reads_(threaded_ && file_name != ":memory:"),
+      fts_available_(false),
+      cleared_up_to_(0),
+      clear_pending_(false),
+      prune_before_created_at_(std::numeric_limits<qint64>::min()),
+      prune_before_id_(0),
+      prune_downloaded_(false),
+      pruned_(0),
+      prune_total_(0),
+      pruning_(false),
+      data_version_(0),
+      last_change_(0),
+      batch_timer_(this),
+      save_timer_(this),
+      purge_timer_(this),
+      change_timer_(this) {
+    // Reader threads are kept since their connections live as long as them
+    read_pool_.setExpiryTimeout(-1);
+
+    batch_timer_.setSingleShot(true);
+    batch_timer_.setInterval(kBatchWindow);
+    QObject::connect(&batch_timer_, &QTimer::timeout, this,
+                     &Database::flush_pending_infos);
+
+    save_timer_.setSingleShot(true);
+    save_timer_.setInterval(kSaveWindow);
+    QObject::connect(&save_timer_, &QTimer::timeout, this,
+                     &Database::flushDownloads);
+
+    purge_timer_.setSingleShot(true);
+    purge_timer_.setInterval(kUndoWindow);
+    QObject::connect(&purge_timer_, &QTimer::timeout, this,
+                     &Database::purgeRemovedVideos);
+
+    change_timer_.setInterval(kChangePollInterval);
+    QObject::connect(&change_timer_, &QTimer::timeout, this,
+                     &Database::checkForChanges);
+
+    if (thread == nullptr) {
+        open(file_name, pragmas);
+        return;
+    }
+
+    // A connection can only be used by the thread that created it
+    moveToThread(thread);
+    QMetaObject::invokeMethod(
+        this, [this, file_name, pragmas] { open(file_name, pragmas); },
+        Qt::QueuedConnection);
+}
+
+// Database::get() is closed at quit instead
+Database::~Database() { close_read_connections(); }
+
+}  // namespace yd_gui
@@ -1,36 +1,129 @@
 #pragma once
 
+#include <qhash.h>
 #include <qlist.h>
+#include <qmutex.h>
 #include <qobject.h>
+#include <qset.h>
 #include <qsqldatabase.h>
 #include <qsqlerror.h>
 #include <qsqlquery.h>
 #include <qstring.h>
+#include <qthread.h>
+#include <qthreadpool.h>
+#include <qtimer.h>
 #include <qtmetamacros.h>
 #include <qtypes.h>
 
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <optional>
+
 #include "video.h"
 
 namespace yd_gui {
 
+// Connection tuning applied to the history when it is opened
+struct DatabasePragmas {
+    QString journal_mode{"WAL"};
+    QString synchronous{"NORMAL"};
+    qint64 mmap_size{static_cast<qint64>(64) * 1024 * 1024};  // bytes
+    qint64 cache_size_kib{8 * 1024};                           // KiB
+    qint64 busy_timeout_ms{5000};                              // ms
+};
+
+// Videos and their total length, of the whole history or of a group of it
+struct HistoryStatsGroup {
+    QString key;  // author, or month as "yyyy-MM" in UTC
+    qint64 videos = 0;
+    qint64 seconds = 0;
+
+    bool operator==(const HistoryStatsGroup& other) const = default;
+};
+
+struct HistoryStats {
+    qint64 videos = 0;
+    qint64 seconds = 0;
+    QList<HistoryStatsGroup> authors;  // most videos first
+    QList<HistoryStatsGroup> months;   // newest first
+};
+
+// Which videos the history keeps, 0 meaning no limit
+struct HistoryRetention {
+    qint64 max_videos = 0;              // newest ones are kept
+    qint64 max_age_days = 0;            // by when they were added
+    bool keep_only_incomplete = false;  // whether downloaded ones are dropped
+};
+
+// A video's download as it's kept in history, see Database::saveDownload()
+struct VideoDownload {
+    qint64 id = 0;
+    DownloadState state = DownloadState::kAdded;
+    float progress = 0;
+    QString selected_format;
+    bool download_thumbnail = false;
+};
+
+/* The history. Database::get() lives on a dedicated thread with its own
+   connection. Slots may be called from any thread (including QML), they are
+   forwarded to the database's thread and their results delivered through
+   signals.
+   Writes go through that one connection. Reads run on a pool of reader
+   threads when the history is file backed and has its own thread, each
+   reading through a read-only connection of its thread. So the synchronous
+   fetch functions may be called from any thread, except on an in-memory
+   history which can only be read from the database's thread.
+ */
 class Database : public QObject {
     Q_OBJECT
 
     Q_PROPERTY(bool valid READ valid NOTIFY validChanged)
 
    public:
+    ~Database() override;
+
     static Database& get();
 
-    static Database get_temp(const QString& connection_name);
+    static Database get_temp(const QString& connection_name,
+                             const QString& file_name = ":memory:",
+                             const DatabasePragmas& pragmas = {});
 
+    // Default page size of history and search results
     static constexpr qint64 kChunkSize = 25;
 
+    // Most authors and months stats() returns
+    static constexpr qint64 kMaxStatsGroups = 100;
+
+    // How long a removed video can be restored before it's purged
+    static constexpr std::chrono::seconds kUndoWindow{10};
+
     bool valid() const;
 
-    QList<ManagedVideoParts> fetch_first_chunk();
+    QList<ManagedVideoParts> fetch_first_chunk(qint64 chunk_size = kChunkSize);
+
+    QList<ManagedVideoParts> fetch_chunk(qint64 last_id, qint64 last_created_at,
+                                         qint64 chunk_size = kChunkSize);
+
+    QList<ManagedVideoParts> fetch_newer_chunk(
+        qint64 first_id, qint64 first_created_at,
+        qint64 chunk_size = kChunkSize);
+
+    QList<ManagedVideoParts> search(
+        const QString& text,
+        qint64 before_id = std::numeric_limits<qint64>::max(),
+        qint64 before_created_at = std::numeric_limits<qint64>::max());
+
+    QList<VideoFormat> fetch_formats(qint64 id);
+
+    HistoryStats stats();
+
+    // Videos left to download, in the order they were queued
+    QList<ManagedVideoParts> download_queue();
 
-    QList<ManagedVideoParts> fetch_chunk(qint64 last_id,
-                                         qint64 last_created_at);
+    std::optional<qint64> export_history(const QString& file_name);
+
+    std::optional<qint64> import_history(const QString& file_name);
 
    signals:
     void validChanged(bool valid);
@@ -39,51 +132,221 @@ class Database : public QObject {
 
     void videosPushed(QList<ManagedVideoParts> videos);
 
+    void chunkFetched(QList<ManagedVideoParts> videos);
+
+    void newerChunkFetched(QList<ManagedVideoParts> videos);
+
+    void searchFetched(QString text, qint64 before_id,
+                       qint64 before_created_at,
+                       QList<ManagedVideoParts> videos);
+
+    void formatsFetched(qint64 id, QList<VideoFormat> formats);
+
+    void statsFetched(HistoryStats stats);
+
+    void downloadQueueFetched(QList<ManagedVideoParts> videos);
+
+    void historyExported(QString file_name, qint64 videos);
+
+    void historyImported(QString file_name, qint64 videos);
+
+    // Changes made to the history by other connections, e.g., another
+    // instance. Videos shown were added, restored or updated, those removed
+    // are gone.
+    void historyChanged(QList<ManagedVideoParts> shown,
+                        QList<qint64> removed);
+
+    // Other connections changed too much of the history for it to be
+    // reported video by video, i.e., they imported or cleared it. It should be
+    // read again.
+    void historyReset();
+
+    // Videos deleted by a batch of pruneHistory()
+    void videosPruned(QList<qint64> ids);
+
+    // Done once pruned is total
+    void pruneProgress(qint64 pruned, qint64 total);
+
+    // stats() changed without videos being pushed, e.g., a video was removed
+    // or a clear finished
+    void statsChanged();
+
    public slots:
     void setValid(bool valid);
 
     void addVideo(VideoInfo info);
 
+    void addVideos(QList<VideoInfo> infos);
+
+    void addVideoBatched(VideoInfo info);
+
     void removeVideo(qint64 id);
 
     void removeAllVideos();
 
+    void restoreVideo(qint64 id);
+
+    void purgeRemovedVideos();
+
+    void saveDownload(VideoDownload download);
+
+    void flushDownloads();
+
+    void enqueueDownload(qint64 id);
+
+    void dequeueDownload(qint64 id);
+
+    void pruneHistory(HistoryRetention retention);
+
+    void fetchFirstChunk(qint64 chunk_size = kChunkSize);
+
+    void fetchChunk(qint64 last_id, qint64 last_created_at,
+                    qint64 chunk_size = kChunkSize);
+
+    void fetchNewerChunk(qint64 first_id, qint64 first_created_at,
+                         qint64 chunk_size = kChunkSize);
+
+    void searchVideos(QString text, qint64 before_id,
+                      qint64 before_created_at);
+
+    void fetchFormats(qint64 id);
+
+    void fetchStats();
+
+    void fetchDownloadQueue();
+
+    void checkForChanges();
+
+    void exportHistory(QString file_name);
+
+    void importHistory(QString file_name);
+
    private:
+    template <typename Fn>
+    bool forward_to_thread(Fn&& fn);
+
+    template <typename Fn>
+    void run_read(Fn&& fn);
+
+    void open(const QString& file_name, const DatabasePragmas& pragmas);
+
+    void close();
+
+    void close_read_connections();
+
     bool create_tables();
 
-    QList<ManagedVideoParts> extract_videos(QSqlQuery videos_query);
+    void resume_clear();
+
+    void remove_cleared();
+
+    bool remove_cleared_batch();
 
-    QList<VideoFormat> extract_formats(QSqlQuery formats_query);
+    bool start_prune(const HistoryRetention& retention);
+
+    void prune();
+
+    bool prune_batch();
+
+    bool watch_changes();
+
+    bool trim_changes();
+
+    QList<ManagedVideoParts> extract_videos(QSqlQuery videos_query);
 
     QSqlQuery create_select_first_chunk_videos(qint64 chunk_size);
 
     QSqlQuery create_select_chunk_videos(qint64 last_id, qint64 last_created_at,
                                          qint64 chunk_size);
 
-    QSqlQuery create_select_formats(qint64 videos_id);
+    QSqlQuery create_select_newer_chunk_videos(qint64 first_id,
+                                               qint64 first_created_at,
+                                               qint64 chunk_size);
+
+    QSqlQuery create_search_videos(const QString& text, qint64 before_id,
+                                   qint64 before_created_at,
+                                   qint64 chunk_size);
+
+    QSqlQuery prepare_insert_video();
+
+    QSqlQuery prepare_import_video();
+
+    std::optional<qint64> insert_video(QSqlQuery& query, const VideoInfo& info,
+                                       qint64 created_at);
 
-    std::optional<qint64> fetch_last_insert_id();
+    QSqlQuery prepare_remove_hidden_copy();
 
-    bool insert_video(const VideoInfo& info, qint64 created_at);
+    bool remove_hidden_copy(QSqlQuery& query, const VideoInfo& info);
 
-    bool insert_format(const VideoFormat& format, qint64 videos_id);
+    void flush_pending_infos();
+
+    bool write_downloads(const QList<VideoDownload>& downloads);
 
     QSqlQuery make_query();
 
     QSqlDatabase make_connection();
 
+    QSqlQuery make_read_query();
+
+    QSqlDatabase read_connection();
+
     void log_error(QString message);
 
     static constexpr auto kDatabaseFileName = "history.db";
 
+    static constexpr std::chrono::milliseconds kBatchWindow{50};
+
+    static constexpr qsizetype kMaxBatchSize = 500;
+
+    // Videos per transaction when importing history
+    static constexpr qint64 kImportBatchSize = 10'000;
+
+    // How long saveDownload()s are gathered before they are written
+    static constexpr std::chrono::milliseconds kSaveWindow{1000};
+
+    // Videos removed per transaction when clearing the history or purging
+    // removed videos
+    static constexpr qint64 kRemoveBatchSize = 500;
+
+    // How often other connections' changes are checked for
+    static constexpr std::chrono::seconds kChangePollInterval{1};
+
+    // How long changes are logged for other connections to pick up
+    static constexpr std::chrono::hours kChangesKept{24};
+
+    // If thread is given, this is moved to it and opened there
     explicit Database(const QString& file_name = kDatabaseFileName,
                       QString connection_name = kDatabaseFileName,
-                      QObject* parent = nullptr);
+                      const DatabasePragmas& pragmas = {},
+                      QThread* thread = nullptr, QObject* parent = nullptr);
 
     QList<ManagedVideoParts> fetch_chunk_impl(QSqlQuery query);
 
-    bool valid_;
+    std::atomic<bool> valid_;
     const QString connection_name_;
+    const DatabasePragmas pragmas_;  // also applied to read connections
+    const bool threaded_;            // whether this has a thread of its own
+    const bool concurrent_reads_;    // whether reads run on read_pool_
+    QThreadPool read_pool_;
+    QMutex read_connections_mutex_;
+    QSet<QString> read_connections_;     // names, guarded by the mutex above
+    bool fts_available_;                 // whether videos_fts could be created
+    std::atomic<qint64> cleared_up_to_;  // videos up to this id are hidden
+    bool clear_pending_;                 // whether hidden videos are left
+    QList<VideoInfo> pending_infos_;     // waiting on batch_timer_ to be added
+    qint64 prune_before_created_at_;     // videos older than this and
+    qint64 prune_before_id_;             // this id are pruned
+    bool prune_downloaded_;              // whether downloaded ones are too
+    qint64 pruned_;                      // by the running prune so far
+    qint64 prune_total_;                 // to be pruned by the running prune
+    bool pruning_;                       // whether a prune is running
+    qint64 data_version_;                // as of the last check for changes
+    qint64 last_change_;                 // seq of the last change checked
+    QTimer batch_timer_;
+    QHash<qint64, VideoDownload> pending_downloads_;  // latest of each video
+    QTimer save_timer_;
+    QTimer purge_timer_;
+    QTimer change_timer_;
 };
 
 }  // namespace yd_gui
@@ -0,0 +1,35 @@
+#include "database_proxy.h"
+
+#include <qobject.h>
+
+#include <utility>
+
+#include "database.h"
+#include "video.h"
+
+namespace yd_gui {
+DatabaseProxy::DatabaseProxy(Database& db, QObject* parent)
+    : QObject(parent), db_(db), valid_(false) {
+    // Queued when db lives on another thread
+    QObject::connect(&db_, &Database::validChanged, this,
+                     &DatabaseProxy::set_valid);
+    QObject::connect(&db_, &Database::errorPushed, this,
+                     &DatabaseProxy::errorPushed);
+
+    // Read once connected so a change made meanwhile isn't missed
+    valid_ = db_.valid();
+}
+
+bool DatabaseProxy::valid() const { return valid_; }
+
+void DatabaseProxy::addVideoBatched(VideoInfo info) {
+    db_.addVideoBatched(std::move(info));
+}
+
+void DatabaseProxy::set_valid(const bool valid) {
+    if (valid_ == valid) return;
+    valid_ = valid;
+    emit validChanged(valid);
+}
+
+}  // namespace yd_gui
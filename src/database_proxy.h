@@ -0,0 +1,43 @@
+#pragma once
+
+#include <qobject.h>
+#include <qstring.h>
+#include <qtmetamacros.h>
+
+#include "database.h"
+#include "video.h"
+
+namespace yd_gui {
+
+/* What QML sees of the history. QML can't bind to or connect to an object of
+   another thread, and Database::get() lives on its own, so this stays on the
+   GUI thread. It mirrors the database's validity and errors through queued
+   connections and forwards what QML asks of the database.
+ */
+class DatabaseProxy : public QObject {
+    Q_OBJECT
+
+    Q_PROPERTY(bool valid READ valid NOTIFY validChanged)
+
+   public:
+    explicit DatabaseProxy(Database& db = Database::get(),
+                           QObject* parent = nullptr);
+
+    bool valid() const;
+
+   signals:
+    void validChanged(bool valid);
+
+    void errorPushed(QString error);
+
+   public slots:
+    void addVideoBatched(VideoInfo info);
+
+   private:
+    void set_valid(bool valid);
+
+    Database& db_;
+    bool valid_;
+};
+
+}  // namespace yd_gui
@@ -223,7 +223,9 @@ QProcess* Downloader::create_download_process(ManagedVideo& video) {
         format_arg = video.selected_format() % "+" % format_arg;
     }
 
+    // Continues from the .part files of a download that was interrupted
     QList<QString> args = {"--quiet",
+                           "--continue",
                            "--progress",
                            "--progress-template",
                            "%(progress._percent_str)s",
@@ -0,0 +1,101 @@
+#include "history_stats_model.h"
+
+#include <qabstractitemmodel.h>
+#include <qbytearray.h>
+#include <qobject.h>
+#include <qtypes.h>
+#include <qvariant.h>
+
+#include <utility>
+
+#include "database.h"
+
+namespace yd_gui {
+HistoryStatsModel::HistoryStatsModel(Database& db, QObject* parent)
+    : QAbstractListModel(parent), db_(db), group_by_(GroupBy::kMonth) {
+    QObject::connect(&db_, &Database::statsFetched, this,
+                     &HistoryStatsModel::on_stats_fetched);
+    QObject::connect(&db_, &Database::videosPushed, this,
+                     &HistoryStatsModel::refresh);
+    QObject::connect(&db_, &Database::pruneProgress, this,
+                     &HistoryStatsModel::refresh);
+    QObject::connect(&db_, &Database::historyImported, this,
+                     &HistoryStatsModel::refresh);
+    QObject::connect(&db_, &Database::statsChanged, this,
+                     &HistoryStatsModel::refresh);
+    QObject::connect(&db_, &Database::historyChanged, this,
+                     &HistoryStatsModel::refresh);
+    QObject::connect(&db_, &Database::historyReset, this,
+                     &HistoryStatsModel::refresh);
+
+    refresh();
+}
+
+int HistoryStatsModel::rowCount(const QModelIndex& parent) const {
+    if (parent.isValid()) return 0;
+    return groups().size();
+}
+
+QVariant HistoryStatsModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || !hasIndex(index.row(), index.column()))
+        return QVariant();
+
+    const HistoryStatsGroup& group = groups().at(index.row());
+
+    switch (static_cast<HistoryStatsModelRole>(role)) {
+        case HistoryStatsModelRole::kKeyRole:
+            return group.key;
+        case HistoryStatsModelRole::kVideosRole:
+            return group.videos;
+        case HistoryStatsModelRole::kSecondsRole:
+            return group.seconds;
+        default:
+            return QVariant();
+    }
+}
+
+QHash<int, QByteArray> HistoryStatsModel::roleNames() const {
+    static const QHash<int, QByteArray> kRoles{
+        {static_cast<int>(HistoryStatsModelRole::kKeyRole), "key"},
+        {static_cast<int>(HistoryStatsModelRole::kVideosRole), "videos"},
+        {static_cast<int>(HistoryStatsModelRole::kSecondsRole), "seconds"}};
+    return kRoles;
+}
+
+qint64 HistoryStatsModel::videos() const { return stats_.videos; }
+
+qint64 HistoryStatsModel::seconds() const { return stats_.seconds; }
+
+HistoryStatsModel::GroupBy HistoryStatsModel::group_by() const {
+    return group_by_;
+}
+
+void HistoryStatsModel::setGroupBy(const GroupBy group_by) {
+    if (group_by == group_by_) return;
+
+    beginResetModel();
+    group_by_ = group_by;
+    endResetModel();
+
+    emit groupByChanged();
+}
+
+// Cheap regardless of the history's size, see Database::stats()
+void HistoryStatsModel::refresh() { db_.fetchStats(); }
+
+void HistoryStatsModel::on_stats_fetched(HistoryStats stats) {
+    const bool totals_changed =
+        stats.videos != stats_.videos || stats.seconds != stats_.seconds;
+
+    beginResetModel();
+    stats_ = std::move(stats);
+    endResetModel();
+
+    if (totals_changed) emit totalsChanged();
+}
+
+const QList<HistoryStatsGroup>& HistoryStatsModel::groups() const {
+    return group_by_ == GroupBy::kAuthor ? stats_.authors : stats_.months;
+}
+
+}  // namespace yd_gui
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <qabstractitemmodel.h>
+#include <qhash.h>
+#include <qlist.h>
+#include <qnamespace.h>
+#include <qobject.h>
+#include <qtmetamacros.h>
+#include <qtypes.h>
+#include <qvariant.h>
+
+#include <QtQmlIntegration>
+
+#include "database.h"
+
+namespace yd_gui {
+
+// Totals of the history, with its authors or months as rows depending on
+// groupBy. Refreshed when videos are added or pruned, or on demand through
+// refresh().
+class HistoryStatsModel : public QAbstractListModel {
+    Q_OBJECT
+    QML_ELEMENT
+    QML_SINGLETON
+    QML_UNCREATABLE("")
+
+    Q_PROPERTY(qint64 videos READ videos NOTIFY totalsChanged)
+    Q_PROPERTY(qint64 seconds READ seconds NOTIFY totalsChanged)
+    Q_PROPERTY(
+        GroupBy groupBy READ group_by WRITE setGroupBy NOTIFY groupByChanged)
+
+   public:
+    enum class HistoryStatsModelRole {
+        kKeyRole = Qt::UserRole,
+        kVideosRole,
+        kSecondsRole,
+    };
+
+    enum class GroupBy {
+        kMonth,
+        kAuthor,
+    };
+    Q_ENUM(GroupBy)
+
+    explicit HistoryStatsModel(Database& db = Database::get(),
+                               QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+
+    QVariant data(const QModelIndex& index,
+                  int role = Qt::DisplayRole) const override;
+
+    QHash<int, QByteArray> roleNames() const override;
+
+    qint64 videos() const;
+
+    qint64 seconds() const;
+
+    GroupBy group_by() const;
+
+   signals:
+    void totalsChanged();
+
+    void groupByChanged();
+
+   public slots:
+    void setGroupBy(GroupBy group_by);
+
+    void refresh();
+
+   private:
+    void on_stats_fetched(HistoryStats stats);
+
+    const QList<HistoryStatsGroup>& groups() const;
+
+    Database& db_;
+    HistoryStats stats_;
+    GroupBy group_by_;
+};
+
+}  // namespace yd_gui
@@ -11,6 +11,9 @@ Rectangle {
     topLeftRadius: Yd.Constants.boxRadius
     topRightRadius: Yd.Constants.boxRadius
 
+    // Once requestDownloadVideo is connected below
+    Component.onCompleted: Yd.VideoListModel.restoreDownloads()
+
     Connections {
         function onRequestDownloadVideo(video) {
             Yd.Downloader.enqueue_video(video);
@@ -18,13 +21,6 @@ Rectangle {
 
         target: Yd.VideoListModel
     }
-    Connections {
-        function onVideosPushed(videos) {
-            Yd.VideoListModel.appendVideos(videos);
-        }
-
-        target: _database
-    }
     ListView {
         id: listView
 
@@ -37,6 +33,13 @@ Rectangle {
         model: Yd.VideoListModelSortedProxy
         spacing: Yd.Constants.boxPadding
 
+        // Rows that fit in the view, estimated from the delegates laid out so far
+        function __updateVisibleRows() {
+            if (count > 0) {
+                Yd.VideoListModel.setVisibleRows(Math.ceil(visibleArea.heightRatio * count));
+            }
+        }
+
         Component.onCompleted: {
             Yd.VideoListModelSortedProxy.setModel(Yd.VideoListModel);
         }
@@ -53,12 +56,23 @@ Rectangle {
             height: listView.spacing
         }
 
+        onCountChanged: __updateVisibleRows()
+        onHeightChanged: __updateVisibleRows()
         on__PositionChanged: {
+            // Read ahead so the next page is ready by the time the end is reached
+            if (__position > 0.8) {
+                Yd.VideoListModel.prefetch();
+            }
             const now = new Date();
-            if (now - __lastCheckedPos > 3000 && __position > 0.99) {
+            if (now - __lastCheckedPos > 250 && __position > 0.99) {
                 __lastCheckedPos = now;
                 Yd.VideoListModel.paginate();
             }
+            // Only pages anything after seeking into the history
+            if (now - __lastCheckedPos > 250 && __position < 0.01) {
+                __lastCheckedPos = now;
+                Yd.VideoListModel.paginateNewer();
+            }
         }
 
         anchors {
@@ -1,245 +1,1134 @@
-#include "video_list_model.h"
-
-#include <qabstractitemmodel.h>
-#include <qalgorithms.h>
-#include <qbytearray.h>
-#include <qobject.h>
-#include <qtmetamacros.h>
-#include <qtpreprocessorsupport.h>
-#include <qtypes.h>
-#include <qvariant.h>
-
-#include <optional>
-
-#include "database.h"
-#include "video.h"
-
-namespace yd_gui {
-VideoListModel::VideoListModel(Database& db, QObject* parent)
-    : QAbstractListModel(parent), db_(db) {
-    paginate();
-}
-
-int VideoListModel::rowCount(const QModelIndex& parent) const {
-    if (parent.isValid()) return 0;
-    return videos_.size();
-}
-
-QVariant VideoListModel::data(const QModelIndex& index, int role) const {
-    if (!index.isValid() || !hasIndex(index.row(), index.column()))
-        return QVariant();
-
-    const int row = index.row();
-
-    auto role_enum = static_cast<VideoListModelRole>(role);
-    if (row < rowCount()) {
-        switch (role_enum) {
-            case VideoListModelRole::kIdRole:
-                return videos_.at(row)->id();
-            case VideoListModelRole::kInfoRole:
-                return QVariant::fromValue(videos_.at(row)->info());
-            case VideoListModelRole::kProgressRole:
-                return videos_.at(row)->progress();
-            case VideoListModelRole::kCreatedAtRole:
-                return videos_.at(row)->created_at();
-            case VideoListModelRole::kSelectedFormatRole:
-                return videos_.at(row)->selected_format();
-            case VideoListModelRole::kDownloadThumbnail:
-                return videos_.at(row)->download_thumbnail();
-            case VideoListModelRole::kState:
-                return QVariant::fromValue(videos_.at(row)->state());
-            default:
-                return QVariant();
-        }
-    }
-
-    return QVariant();
-}
-
-bool VideoListModel::setData(const QModelIndex& index, const QVariant& value,
-                             int role) {
-    if (!index.isValid() || !hasIndex(index.row(), index.column()))
-        return false;
-
-    const int row = index.row();
-
-    auto role_enum = static_cast<VideoListModelRole>(role);
-    switch (role_enum) {
-        case VideoListModelRole::kIdRole:
-        case VideoListModelRole::kInfoRole:
-            break;
-        case VideoListModelRole::kProgressRole: {
-            bool ok = false;
-            float progress = value.toFloat(&ok);
-            if (!ok) break;
-
-            if (progress == videos_[row]->progress()) return true;
-
-            videos_[row]->setProgress(progress, false);
-            emit dataChanged(index, index, {role});
-            return true;
-        }
-        case VideoListModelRole::kCreatedAtRole:
-            break;
-        case VideoListModelRole::kSelectedFormatRole: {
-            QString selected_format = value.toString();
-
-            if (selected_format == videos_[row]->selected_format()) return true;
-
-            videos_[row]->setSelectedFormat(selected_format, false);
-            emit dataChanged(index, index, {role});
-            return true;
-        }
-        case VideoListModelRole::kDownloadThumbnail: {
-            bool download_thumbnail = value.toBool();
-
-            if (download_thumbnail == videos_[row]->download_thumbnail())
-                return true;
-
-            videos_[row]->setDownloadThumbnail(download_thumbnail, false);
-            emit dataChanged(index, index, {role});
-            return true;
-        }
-        case VideoListModelRole::kState: {
-            if (!value.canConvert<DownloadState>()) break;
-
-            auto state = value.value<DownloadState>();
-
-            if (state == videos_[row]->state()) return true;
-
-            videos_[row]->setState(state, false);
-            emit dataChanged(index, index, {role});
-            return true;
-        }
-    }
-
-    return false;
-}
-
-QHash<int, QByteArray> VideoListModel::roleNames() const {
-    static const QHash<int, QByteArray> kRoles{
-        {static_cast<int>(VideoListModelRole::kIdRole), "dbId"},
-        {static_cast<int>(VideoListModelRole::kInfoRole), "info"},
-        {static_cast<int>(VideoListModelRole::kProgressRole), "progress"},
-        {static_cast<int>(VideoListModelRole::kCreatedAtRole), "createdAt"},
-        {static_cast<int>(VideoListModelRole::kSelectedFormatRole),
-         "selectedFormat"},
-        {static_cast<int>(VideoListModelRole::kDownloadThumbnail),
-         "downloadThumbnail"},
-        {static_cast<int>(VideoListModelRole::kState), "state"}};
-    return kRoles;
-}
-
-QModelIndex VideoListModel::find_video(ManagedVideo& video) const {
-    if (video.cached_index().has_value() &&
-        hasIndex(*video.cached_index(), 0) &&
-        &video == videos_[*video.cached_index()]) {
-        return this->index(*video.cached_index());
-    }
-
-    const qsizetype index = videos_.indexOf(&video);
-
-    if (index == static_cast<qsizetype>(-1)) return QModelIndex();
-
-    video.setCachedIndex(index);
-
-    return this->index(index);
-}
-
-void VideoListModel::update_video(ManagedVideo& video,
-                                  const QList<int>& roles) {
-    QModelIndex index = find_video(video);
-    if (!index.isValid()) return;
-
-    emit dataChanged(index, index, roles);
-}
-
-void VideoListModel::removeVideo(int row) {
-    if (!hasIndex(row, 0)) return;
-
-    beginRemoveRows(QModelIndex(), row, row);
-    auto* const video = videos_.takeAt(row);
-    endRemoveRows();
-
-    emit video->requestCancelDownload();
-
-    db_.removeVideo(video->id());
-
-    video->deleteLater();
-}
-
-void VideoListModel::removeAllVideos() {
-    if (videos_.empty()) return;
-
-    beginRemoveRows(QModelIndex(), 0, videos_.size() - 1);
-    QList<ManagedVideo*> videos = videos_;
-    videos_.clear();
-    endRemoveRows();
-
-    db_.removeAllVideos();
-
-    for (auto* const video : videos) {
-        emit video->requestCancelDownload();
-        video->deleteLater();
-    }
-}
-
-void VideoListModel::downloadVideo(int row) {
-    if (!hasIndex(row, 0)) return;
-
-    if (videos_[row]->state() == DownloadState::kAdded ||
-        videos_[row]->state() == DownloadState::kComplete)
-        emit requestDownloadVideo(videos_[row]);
-}
-
-void VideoListModel::downloadAllVideos() {
-    for (auto* const video : videos_) {
-        if (video->state() == DownloadState::kAdded)
-            emit requestDownloadVideo(video);
-    }
-}
-
-void VideoListModel::cancelDownload(int row) {
-    if (!hasIndex(row, 0)) return;
-
-    emit videos_[row]->requestCancelDownload();
-}
-
-void VideoListModel::cancelAllDownloads() {
-    for (auto* const video : videos_) {
-        emit video->requestCancelDownload();
-    }
-}
-
-void VideoListModel::prependVideos(QList<ManagedVideoParts> parts) {
-    while (!parts.empty()) {
-        beginInsertRows(QModelIndex(), 0, 0);
-        videos_.prepend(new ManagedVideo(parts.takeLast(), this));
-        endInsertRows();
-    }
-}
-
-void VideoListModel::appendVideos(QList<ManagedVideoParts> parts) {
-    if (parts.empty()) return;
-
-    QList<ManagedVideo*> videos;
-    videos.reserve(parts.size());
-
-    while (!parts.empty()) {
-        videos << new ManagedVideo(parts.takeFirst(), this);
-    }
-
-    beginInsertRows(QModelIndex(), videos_.size(),
-                    videos_.size() + videos.size() - 1);
-    videos_.append(std::move(videos));
-    endInsertRows();
-}
-
-void VideoListModel::paginate() {
-    prependVideos(videos_.empty()
-                      ? db_.fetch_first_chunk()
-                      : db_.fetch_chunk(videos_.first()->id(),
-                                        videos_.first()->created_at()));
-}
-
-}  // namespace yd_gui
+#include "video_list_model.h"
+
+#include <qabstractitemmodel.h>
+#include <qalgorithms.h>
+#include <qbytearray.h>
+#include <qdatetime.h>
+#include <qdebug.h>
+#include <qhash.h>
+#include <qobject.h>
+#include <qtimer.h>
+#include <qtmetamacros.h>
+#include <qtpreprocessorsupport.h>
+#include <qtypes.h>
+#include <qvariant.h>
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <utility>
+
+#include "application_settings.h"
+#include "database.h"
+#include "video.h"
+
+namespace yd_gui {
+qsizetype VideoRows::size() const { return ids_.size(); }
+
+bool VideoRows::empty() const { return ids_.empty(); }
+
+// Each column keeps free space at its front once prepended to, so prepending
+// is amortized O(1) per row
+void VideoRows::prepend(QList<ManagedVideoParts> parts) {
+    const bool download_thumbnail =
+        ApplicationSettings::get().downloadThumbnail();
+
+    for (auto it = parts.rbegin(); it != parts.rend(); ++it) {
+        ManagedVideoParts row = resolved(std::move(*it), download_thumbnail);
+        ordinals_.insert(row.id, --base_);
+        ids_.prepend(row.id);
+        created_ats_.prepend(row.created_at);
+        infos_.prepend(std::move(row.info));
+        formats_loaded_.prepend(row.formats_loaded);
+        progress_.prepend(row.progress);
+        selected_formats_.prepend(std::move(row.selected_format));
+        download_thumbnails_.prepend(*row.download_thumbnail);
+        states_.prepend(row.state);
+        videos_.prepend(nullptr);
+    }
+}
+
+void VideoRows::append(QList<ManagedVideoParts> parts) {
+    const bool download_thumbnail =
+        ApplicationSettings::get().downloadThumbnail();
+
+    for (auto& video_parts : parts) {
+        ManagedVideoParts row =
+            resolved(std::move(video_parts), download_thumbnail);
+        ordinals_.insert(row.id, base_ + ids_.size());
+        ids_ << row.id;
+        created_ats_ << row.created_at;
+        infos_ << std::move(row.info);
+        formats_loaded_ << row.formats_loaded;
+        progress_ << row.progress;
+        selected_formats_ << std::move(row.selected_format);
+        download_thumbnails_ << *row.download_thumbnail;
+        states_ << row.state;
+        videos_ << nullptr;
+    }
+}
+
+void VideoRows::remove(const qsizetype first, const qsizetype count) {
+    for (qsizetype row = first; row < first + count; ++row) {
+        ordinals_.remove(ids_[row]);
+    }
+
+    ids_.remove(first, count);
+    created_ats_.remove(first, count);
+    infos_.remove(first, count);
+    formats_loaded_.remove(first, count);
+    progress_.remove(first, count);
+    selected_formats_.remove(first, count);
+    download_thumbnails_.remove(first, count);
+    states_.remove(first, count);
+    videos_.remove(first, count);
+
+    if (first < size() - first) {
+        // The rows before them move down instead
+        base_ += count;
+        for (qsizetype before = 0; before < first; ++before) {
+            ordinals_[ids_[before]] = base_ + before;
+        }
+    } else {
+        for (qsizetype after = first; after < size(); ++after) {
+            ordinals_[ids_[after]] = base_ + after;
+        }
+    }
+}
+
+void VideoRows::clear() { remove(0, size()); }
+
+qsizetype VideoRows::row_of(const qint64 id) const {
+    const auto ordinal = ordinals_.constFind(id);
+    return ordinal != ordinals_.cend() ? *ordinal - base_ : -1;
+}
+
+qint64 VideoRows::id(const qsizetype row) const { return ids_[row]; }
+
+qint64 VideoRows::created_at(const qsizetype row) const {
+    return created_ats_[row];
+}
+
+const VideoInfo& VideoRows::info(const qsizetype row) const {
+    return videos_[row] != nullptr ? videos_[row]->info() : infos_[row];
+}
+
+bool VideoRows::formats_loaded(const qsizetype row) const {
+    return videos_[row] != nullptr ? videos_[row]->formats_loaded()
+                                   : formats_loaded_[row];
+}
+
+float VideoRows::progress(const qsizetype row) const {
+    return videos_[row] != nullptr ? videos_[row]->progress()
+                                   : progress_[row];
+}
+
+const QString& VideoRows::selected_format(const qsizetype row) const {
+    return videos_[row] != nullptr ? videos_[row]->selected_format()
+                                   : selected_formats_[row];
+}
+
+bool VideoRows::download_thumbnail(const qsizetype row) const {
+    return videos_[row] != nullptr ? videos_[row]->download_thumbnail()
+                                   : download_thumbnails_[row];
+}
+
+DownloadState VideoRows::state(const qsizetype row) const {
+    return videos_[row] != nullptr ? videos_[row]->state() : states_[row];
+}
+
+ManagedVideo* VideoRows::video(const qsizetype row) const {
+    return videos_[row];
+}
+
+ManagedVideoParts VideoRows::parts(const qsizetype row) const {
+    return {.id = id(row),
+            .created_at = created_at(row),
+            .info = info(row),
+            .state = state(row),
+            .formats_loaded = formats_loaded(row),
+            .progress = progress(row),
+            .selected_format = selected_format(row),
+            .download_thumbnail = download_thumbnail(row)};
+}
+
+// The video holds the row's fields from then on
+void VideoRows::set_video(const qsizetype row, ManagedVideo* const video) {
+    videos_[row] = video;
+    infos_[row] = VideoInfo();
+    selected_formats_[row].clear();
+}
+
+ManagedVideoParts VideoRows::resolved(ManagedVideoParts parts,
+                                      const bool download_thumbnail) {
+    if (parts.selected_format.isEmpty() && !parts.info.formats().empty()) {
+        parts.selected_format = parts.info.formats().last().format_id();
+    }
+    if (!parts.download_thumbnail.has_value()) {
+        parts.download_thumbnail = download_thumbnail;
+    }
+    return parts;
+}
+
+VideoListModel::VideoListModel(Database& db, QObject* parent)
+    : QAbstractListModel(parent),
+      db_(db),
+      paginating_(false),
+      paginating_newer_(false),
+      show_next_chunk_(false),
+      show_next_newer_chunk_(false),
+      drop_next_chunk_(false),
+      drop_next_newer_chunk_(false),
+      history_exhausted_(false),
+      visible_rows_(0),
+      page_size_(Database::kChunkSize),
+      requested_size_(0),
+      requested_newer_size_(0),
+      row_cost_ns_(0),
+      free_timer_(this),
+      update_timer_(this) {
+    free_timer_.setInterval(0);
+    QObject::connect(&free_timer_, &QTimer::timeout, this,
+                     &VideoListModel::free_removed_videos);
+
+    update_timer_.setSingleShot(true);
+    update_timer_.setInterval(static_cast<int>(
+        1000 / std::max<qint64>(ApplicationSettings::get().uiMaxUpdateRate(),
+                                1)));
+    QObject::connect(&update_timer_, &QTimer::timeout, this,
+                     &VideoListModel::flushUpdates);
+
+    // Queued when db lives on another thread
+    QObject::connect(&db_, &Database::videosPushed, this,
+                     &VideoListModel::on_videos_pushed);
+    QObject::connect(&db_, &Database::chunkFetched, this,
+                     &VideoListModel::on_chunk_fetched);
+    QObject::connect(&db_, &Database::newerChunkFetched, this,
+                     &VideoListModel::on_newer_chunk_fetched);
+    QObject::connect(&db_, &Database::formatsFetched, this,
+                     &VideoListModel::on_formats_fetched);
+    QObject::connect(&db_, &Database::downloadQueueFetched, this,
+                     &VideoListModel::on_download_queue_fetched);
+    QObject::connect(&db_, &Database::historyChanged, this,
+                     &VideoListModel::on_history_changed);
+    QObject::connect(&db_, &Database::videosPruned, this,
+                     &VideoListModel::on_videos_pruned);
+    QObject::connect(&db_, &Database::historyImported, this,
+                     &VideoListModel::reload_history);
+    QObject::connect(&db_, &Database::historyReset, this,
+                     &VideoListModel::reload_history);
+
+    paginate();
+}
+
+int VideoListModel::rowCount(const QModelIndex& parent) const {
+    if (parent.isValid()) return 0;
+    return static_cast<int>(rows_.size());
+}
+
+QVariant VideoListModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || !hasIndex(index.row(), index.column()))
+        return QVariant();
+
+    const int row = index.row();
+
+    auto role_enum = static_cast<VideoListModelRole>(role);
+    if (row < rowCount()) {
+        switch (role_enum) {
+            case VideoListModelRole::kIdRole:
+                return rows_.id(row);
+            case VideoListModelRole::kInfoRole:
+                return QVariant::fromValue(rows_.info(row));
+            case VideoListModelRole::kProgressRole:
+                return rows_.progress(row);
+            case VideoListModelRole::kCreatedAtRole:
+                return rows_.created_at(row);
+            case VideoListModelRole::kSelectedFormatRole:
+                return rows_.selected_format(row);
+            case VideoListModelRole::kDownloadThumbnail:
+                return rows_.download_thumbnail(row);
+            case VideoListModelRole::kState:
+                return QVariant::fromValue(rows_.state(row));
+            case VideoListModelRole::kFormatsLoaded:
+                return rows_.formats_loaded(row);
+            default:
+                return QVariant();
+        }
+    }
+
+    return QVariant();
+}
+
+bool VideoListModel::setData(const QModelIndex& index, const QVariant& value,
+                             int role) {
+    if (!index.isValid() || !hasIndex(index.row(), index.column()))
+        return false;
+
+    const int row = index.row();
+
+    auto role_enum = static_cast<VideoListModelRole>(role);
+    switch (role_enum) {
+        case VideoListModelRole::kIdRole:
+        case VideoListModelRole::kInfoRole:
+            break;
+        case VideoListModelRole::kProgressRole: {
+            bool ok = false;
+            float progress = value.toFloat(&ok);
+            if (!ok) break;
+
+            if (progress == rows_.progress(row)) return true;
+
+            video_at(row)->setProgress(progress, false);
+            emit dataChanged(index, index, {role});
+            return true;
+        }
+        case VideoListModelRole::kCreatedAtRole:
+            break;
+        case VideoListModelRole::kSelectedFormatRole: {
+            QString selected_format = value.toString();
+
+            if (selected_format == rows_.selected_format(row)) return true;
+
+            video_at(row)->setSelectedFormat(selected_format, false);
+            emit dataChanged(index, index, {role});
+            return true;
+        }
+        case VideoListModelRole::kDownloadThumbnail: {
+            bool download_thumbnail = value.toBool();
+
+            if (download_thumbnail == rows_.download_thumbnail(row))
+                return true;
+
+            video_at(row)->setDownloadThumbnail(download_thumbnail, false);
+            emit dataChanged(index, index, {role});
+            return true;
+        }
+        case VideoListModelRole::kState: {
+            if (!value.canConvert<DownloadState>()) break;
+
+            auto state = value.value<DownloadState>();
+
+            if (state == rows_.state(row)) return true;
+
+            video_at(row)->setState(state, false);
+            emit dataChanged(index, index, {role});
+            return true;
+        }
+        case VideoListModelRole::kFormatsLoaded:
+            break;
+    }
+
+    return false;
+}
+
+QHash<int, QByteArray> VideoListModel::roleNames() const {
+    static const QHash<int, QByteArray> kRoles{
+        {static_cast<int>(VideoListModelRole::kIdRole), "dbId"},
+        {static_cast<int>(VideoListModelRole::kInfoRole), "info"},
+        {static_cast<int>(VideoListModelRole::kProgressRole), "progress"},
+        {static_cast<int>(VideoListModelRole::kCreatedAtRole), "createdAt"},
+        {static_cast<int>(VideoListModelRole::kSelectedFormatRole),
+         "selectedFormat"},
+        {static_cast<int>(VideoListModelRole::kDownloadThumbnail),
+         "downloadThumbnail"},
+        {static_cast<int>(VideoListModelRole::kState), "state"},
+        {static_cast<int>(VideoListModelRole::kFormatsLoaded),
+         "formatsLoaded"}};
+    return kRoles;
+}
+
+// O(1) however large the history is, see VideoRows::row_of()
+QModelIndex VideoListModel::find_video(const ManagedVideo& video) const {
+    const qsizetype row = rows_.row_of(video.id());
+    if (row < 0 || rows_.video(row) != &video) return QModelIndex();
+
+    return this->index(static_cast<int>(row));
+}
+
+/* Gathered until flushUpdates(), at most uiMaxUpdateRate times per second,
+   so downloads reporting progress many times a second each don't make QML
+   re-evaluate their rows as often
+ */
+void VideoListModel::update_video(const ManagedVideo& video,
+                                  const QList<int>& roles) {
+    if (!find_video(video).isValid()) return;
+
+    QList<int>& pending_roles = pending_updates_[&video];
+    for (const int role : roles) {
+        if (!pending_roles.contains(role)) pending_roles << role;
+    }
+
+    if (!update_timer_.isActive()) update_timer_.start();
+}
+
+// Adjacent rows are merged into one range with the roles of all of them
+void VideoListModel::flushUpdates() {
+    update_timer_.stop();
+
+    QList<std::pair<int, QList<int>>> updates;
+    updates.reserve(pending_updates_.size());
+    for (auto it = pending_updates_.cbegin(); it != pending_updates_.cend();
+         ++it) {
+        const QModelIndex index = find_video(*it.key());
+        if (index.isValid()) updates.emplace_back(index.row(), it.value());
+    }
+    pending_updates_.clear();
+
+    std::sort(updates.begin(), updates.end(),
+              [](const auto& lhs, const auto& rhs) {
+                  return lhs.first < rhs.first;
+              });
+
+    for (qsizetype begin = 0; begin < updates.size();) {
+        QList<int> roles = updates[begin].second;
+
+        qsizetype end = begin + 1;
+        for (; end < updates.size() &&
+               updates[end].first == updates[end - 1].first + 1;
+             ++end) {
+            for (const int role : std::as_const(updates[end].second)) {
+                if (!roles.contains(role)) roles << role;
+            }
+        }
+
+        emit dataChanged(index(updates[begin].first),
+                         index(updates[end - 1].first), roles);
+        begin = end;
+    }
+}
+
+void VideoListModel::removeVideo(int row) {
+    if (!hasIndex(row, 0)) return;
+
+    const qint64 id = rows_.id(row);
+
+    beginRemoveRows(QModelIndex(), row, row);
+    auto* const video = take_row(row);
+    endRemoveRows();
+
+    if (video != nullptr) emit video->requestCancelDownload();
+
+    db_.removeVideo(id);
+    trim_removed_ids();
+    removed_ids_.emplace_back(id, QDateTime::currentSecsSinceEpoch());
+
+    if (video != nullptr) video->deleteLater();
+}
+
+// Brings back the most recently removed video, which arrives through
+// on_videos_pushed(). Does nothing once its undo window has passed, see
+// Database::removeVideo().
+void VideoListModel::undoRemoveVideo() {
+    trim_removed_ids();
+    if (removed_ids_.empty()) return;
+
+    db_.restoreVideo(removed_ids_.takeLast().first);
+}
+
+// Removals past their undo window can't be undone anymore
+void VideoListModel::trim_removed_ids() {
+    const qint64 cutoff =
+        QDateTime::currentSecsSinceEpoch() - Database::kUndoWindow.count();
+    const auto undoable =
+        std::find_if(removed_ids_.cbegin(), removed_ids_.cend(),
+                     [cutoff](const auto& removed) {
+                         return removed.second > cutoff;
+                     });
+    removed_ids_.erase(removed_ids_.cbegin(), undoable);
+}
+
+void VideoListModel::removeAllVideos() {
+    if (rows_.empty()) return;
+
+    // Older and newer history is removed too
+    read_ahead_.clear();
+    drop_next_chunk_ = paginating_;
+    show_next_chunk_ = false;
+    history_exhausted_ = true;
+    drop_next_newer_chunk_ = paginating_newer_;
+    show_next_newer_chunk_ = false;
+    newer_cursor_.reset();
+
+    beginRemoveRows(QModelIndex(), 0, static_cast<int>(rows_.size() - 1));
+    for (qsizetype row = 0; row < rows_.size(); ++row) {
+        auto* const video = rows_.video(row);
+        if (video == nullptr) continue;
+
+        if (video->state() == DownloadState::kQueued ||
+            video->state() == DownloadState::kDownloading) {
+            emit video->requestCancelDownload();
+        }
+        removed_videos_ << video;
+    }
+    rows_.clear();
+    endRemoveRows();
+    pending_updates_.clear();
+    pending_downloads_.clear();
+    restored_ids_.clear();
+    removed_ids_.clear();
+
+    db_.removeAllVideos();
+
+    // Spread over event loop iterations in case many videos were downloaded
+    if (!removed_videos_.empty()) free_timer_.start();
+}
+
+void VideoListModel::free_removed_videos() {
+    const qsizetype count =
+        std::min<qsizetype>(kFreeBatchSize, removed_videos_.size());
+    for (qsizetype i = 0; i < count; ++i) {
+        removed_videos_[i]->deleteLater();
+    }
+    removed_videos_.remove(0, count);
+
+    if (removed_videos_.empty()) free_timer_.stop();
+}
+
+void VideoListModel::downloadVideo(int row) {
+    if (!hasIndex(row, 0)) return;
+
+    if (rows_.state(row) == DownloadState::kAdded ||
+        rows_.state(row) == DownloadState::kComplete)
+        request_download(video_at(row));
+}
+
+void VideoListModel::downloadAllVideos() {
+    for (qsizetype row = 0; row < rows_.size(); ++row) {
+        if (rows_.state(row) == DownloadState::kAdded)
+            request_download(video_at(row));
+    }
+}
+
+void VideoListModel::cancelDownload(int row) {
+    if (!hasIndex(row, 0)) return;
+
+    pending_downloads_.remove(rows_.id(row));
+    if (auto* const video = rows_.video(row))
+        emit video->requestCancelDownload();
+}
+
+// Only rows with a video can be downloading
+void VideoListModel::cancelAllDownloads() {
+    pending_downloads_.clear();
+    for (qsizetype row = 0; row < rows_.size(); ++row) {
+        if (auto* const video = rows_.video(row))
+            emit video->requestCancelDownload();
+    }
+}
+
+// e.g., when the format picker of a video from history is opened
+void VideoListModel::loadFormats(int row) {
+    if (!hasIndex(row, 0)) return;
+
+    request_formats(rows_.id(row), rows_.formats_loaded(row));
+}
+
+void VideoListModel::request_formats(const qint64 id,
+                                     const bool formats_loaded) {
+    if (formats_loaded || formats_requested_.contains(id)) return;
+
+    formats_requested_.insert(id);
+    db_.fetchFormats(id);
+}
+
+// A video from history is downloaded once its formats arrive, so it has a
+// format selected
+void VideoListModel::request_download(ManagedVideo* const video) {
+    if (video->formats_loaded()) {
+        emit requestDownloadVideo(video);
+        return;
+    }
+
+    pending_downloads_.insert(video->id());
+    request_formats(video->id(), video->formats_loaded());
+}
+
+void VideoListModel::on_formats_fetched(const qint64 id,
+                                        QList<VideoFormat> formats) {
+    formats_requested_.remove(id);
+    const bool download = pending_downloads_.remove(id);
+
+    // The video may have been removed in the meantime
+    const qsizetype row = rows_.row_of(id);
+    if (row < 0) return;
+
+    // Its formats are about to be picked from or downloaded
+    ManagedVideo* const video = video_at(row);
+    video->setFormats(std::move(formats));
+
+    if (download && (video->state() == DownloadState::kAdded ||
+                     video->state() == DownloadState::kComplete)) {
+        emit requestDownloadVideo(video);
+    }
+}
+
+// Its download is saved to history whenever it changes
+ManagedVideo* VideoListModel::make_video(ManagedVideoParts parts) {
+    auto* const video = new ManagedVideo(std::move(parts), this);
+
+    const auto save = [this, video] {
+        db_.saveDownload(
+            VideoDownload{.id = video->id(),
+                          .state = video->state(),
+                          .progress = video->progress(),
+                          .selected_format = video->selected_format(),
+                          .download_thumbnail = video->download_thumbnail()});
+    };
+    QObject::connect(video, &ManagedVideo::stateChanged, this, save);
+    QObject::connect(video, &ManagedVideo::progressChanged, this, save);
+    QObject::connect(video, &ManagedVideo::selectedFormatChanged, this, save);
+    QObject::connect(video, &ManagedVideo::downloadThumbnailChanged, this,
+                     save);
+
+    // Kept queued while downloading, so it's resumed if the app quits
+    QObject::connect(video, &ManagedVideo::stateChanged, this,
+                     [this, video](const DownloadState state) {
+                         switch (state) {
+                             case DownloadState::kQueued:
+                                 db_.enqueueDownload(video->id());
+                                 break;
+                             case DownloadState::kAdded:
+                             case DownloadState::kComplete:
+                                 db_.dequeueDownload(video->id());
+                                 break;
+                             case DownloadState::kDownloading:
+                                 break;
+                         }
+                     });
+
+    return video;
+}
+
+/* Rows only get a ManagedVideo once one is needed, e.g., to be downloaded or
+   edited. It's kept while the row is loaded since the downloader may still
+   hold it.
+ */
+ManagedVideo* VideoListModel::video_at(const qsizetype row) {
+    if (auto* const video = rows_.video(row)) return video;
+
+    auto* const video = make_video(rows_.parts(row));
+    rows_.set_video(row, video);
+    return video;
+}
+
+/* Inserted as one block of rows, without moving the rows already loaded, see
+   VideoRows::prepend(). A page read while videos were being added may hold
+   ones appendVideos() already shows, which are skipped.
+ */
+void VideoListModel::prependVideos(QList<ManagedVideoParts> parts) {
+    parts.removeIf([this](const ManagedVideoParts& video) {
+        return rows_.row_of(video.id) >= 0;
+    });
+    if (parts.empty()) return;
+
+    const qsizetype count = parts.size();
+    beginInsertRows(QModelIndex(), 0, static_cast<int>(count - 1));
+    rows_.prepend(std::move(parts));
+    endInsertRows();
+
+    evict_newest();
+}
+
+/* Videos added again are upserted by the database, keeping their id. Their
+   stale rows are replaced so the refreshed video shows up once at the end. A
+   row that is queued or downloading is left as is instead.
+ */
+void VideoListModel::appendVideos(QList<ManagedVideoParts> parts) {
+    if (parts.empty()) return;
+
+    // Position of the last occurrence of each id within the batch
+    QHash<qint64, qsizetype> pushed_ids;
+    for (qsizetype i = 0; i < parts.size(); ++i) {
+        pushed_ids.insert(parts[i].id, i);
+    }
+
+    // Taken from the last up so the rows before stay put
+    QList<qsizetype> stale_rows;
+    for (auto it = pushed_ids.cbegin(); it != pushed_ids.cend(); ++it) {
+        if (const qsizetype row = rows_.row_of(it.key()); row >= 0)
+            stale_rows << row;
+    }
+    std::sort(stale_rows.begin(), stale_rows.end(), std::greater<>());
+
+    for (const qsizetype row : std::as_const(stale_rows)) {
+        const qint64 id = rows_.id(row);
+
+        if (rows_.state(row) == DownloadState::kQueued ||
+            rows_.state(row) == DownloadState::kDownloading) {
+            pushed_ids.remove(id);
+            continue;
+        }
+
+        beginRemoveRows(QModelIndex(), static_cast<int>(row),
+                        static_cast<int>(row));
+        auto* const video = take_row(row);
+        endRemoveRows();
+
+        if (video != nullptr) video->deleteLater();
+    }
+
+    // Read ahead before it was added again
+    read_ahead_.removeIf([&pushed_ids](const ManagedVideoParts& parts) {
+        return pushed_ids.contains(parts.id);
+    });
+
+    QList<ManagedVideoParts> appended;
+    appended.reserve(pushed_ids.size());
+
+    for (qsizetype i = 0; i < parts.size(); ++i) {
+        if (pushed_ids.value(parts[i].id, -1) != i) continue;
+        appended << std::move(parts[i]);
+    }
+    if (appended.empty()) return;
+
+    beginInsertRows(QModelIndex(), static_cast<int>(rows_.size()),
+                    static_cast<int>(rows_.size() + appended.size() - 1));
+    rows_.append(std::move(appended));
+    endInsertRows();
+}
+
+// nullptr if the row had no video
+ManagedVideo* VideoListModel::take_row(const qsizetype row) {
+    const QList<ManagedVideo*> videos = take_rows(row, 1);
+    return videos.empty() ? nullptr : videos.first();
+}
+
+/* Returns the videos of the rows that had one. Rows shown ahead of their
+   page are shown with it again once they're taken.
+ */
+QList<ManagedVideo*> VideoListModel::take_rows(const qsizetype first,
+                                               const qsizetype count) {
+    QList<ManagedVideo*> videos;
+    for (qsizetype row = first; row < first + count; ++row) {
+        restored_ids_.remove(rows_.id(row));
+
+        auto* const video = rows_.video(row);
+        if (video == nullptr) continue;
+
+        pending_updates_.remove(video);
+        videos << video;
+    }
+    rows_.remove(first, count);
+
+    return videos;
+}
+
+// Whether a row has to stay loaded, i.e., it's being downloaded or is about to
+// be
+bool VideoListModel::is_pinned(const qsizetype row) const {
+    return rows_.state(row) == DownloadState::kQueued ||
+           rows_.state(row) == DownloadState::kDownloading ||
+           pending_downloads_.contains(rows_.id(row));
+}
+
+/* Unloads the rows is_evicted picks, except pinned ones which are kept ahead
+   of their page. Returns the (created_at, id) of the rows unloaded. Their
+   videos, if they had any, are freed later.
+ */
+QList<std::pair<qint64, qint64>> VideoListModel::evict_rows(
+    const std::function<bool(qsizetype)>& is_evicted) {
+    QList<std::pair<qint64, qint64>> evicted;
+
+    for (qsizetype row = rows_.size() - 1; row >= 0;) {
+        if (!is_evicted(row)) {
+            --row;
+            continue;
+        }
+
+        if (is_pinned(row)) {
+            restored_ids_.insert(rows_.id(row));
+            --row;
+            continue;
+        }
+
+        // Unpinned rows next to each other go at once
+        qsizetype first = row;
+        while (first > 0 && is_evicted(first - 1) && !is_pinned(first - 1))
+            --first;
+
+        for (qsizetype unpinned = first; unpinned <= row; ++unpinned) {
+            evicted.emplace_back(rows_.created_at(unpinned),
+                                 rows_.id(unpinned));
+        }
+
+        beginRemoveRows(QModelIndex(), static_cast<int>(first),
+                        static_cast<int>(row));
+        removed_videos_.append(take_rows(first, row - first + 1));
+        endRemoveRows();
+
+        row = first - 1;
+    }
+
+    if (!removed_videos_.empty()) free_timer_.start();
+
+    return evicted;
+}
+
+/* (created_at, id) of the row past which rows are unloaded to keep at most
+   kWindowRows loaded, from the newest end or else the oldest. Pinned rows
+   count towards the window but are kept. nullopt if none are unloaded.
+ */
+std::optional<std::pair<qint64, qint64>> VideoListModel::window_bound(
+    const bool newest) const {
+    const qsizetype excess = rows_.size() - kWindowRows;
+    if (excess <= 0) return std::nullopt;
+
+    QList<std::pair<qint64, qint64>> keys;
+    keys.reserve(rows_.size());
+    for (qsizetype row = 0; row < rows_.size(); ++row) {
+        if (!is_pinned(row))
+            keys.emplace_back(rows_.created_at(row), rows_.id(row));
+    }
+    if (keys.empty()) return std::nullopt;
+
+    const qsizetype count = std::min(excess, keys.size());
+    const auto bound = keys.begin() + (count - 1);
+    if (newest) {
+        std::nth_element(keys.begin(), bound, keys.end(), std::greater<>());
+    } else {
+        std::nth_element(keys.begin(), bound, keys.end());
+    }
+    return *bound;
+}
+
+/* Keeps at most kWindowRows loaded as older pages are shown by unloading the
+   newest rows, which paginateNewer() loads again. Starts right before the
+   oldest of them. They're picked by (created_at, id) rather than by where
+   they are, since pushed and restored videos are appended after older rows.
+ */
+void VideoListModel::evict_newest() {
+    const auto bound = window_bound(true);
+    if (!bound.has_value()) return;
+
+    const QList<std::pair<qint64, qint64>> evicted =
+        evict_rows([this, &bound](const qsizetype row) {
+            return std::pair(rows_.created_at(row), rows_.id(row)) >= *bound;
+        });
+    if (evicted.empty()) return;
+
+    drop_next_newer_chunk_ = paginating_newer_;
+    show_next_newer_chunk_ = false;
+    const auto [created_at, id] =
+        *std::min_element(evicted.cbegin(), evicted.cend());
+    newer_cursor_ = {id - 1, created_at};
+}
+
+// Likewise as newer pages are shown, paginate() loads the oldest rows again
+void VideoListModel::evict_oldest() {
+    const auto bound = window_bound(false);
+    if (!bound.has_value()) return;
+
+    const QList<std::pair<qint64, qint64>> evicted =
+        evict_rows([this, &bound](const qsizetype row) {
+            return std::pair(rows_.created_at(row), rows_.id(row)) <= *bound;
+        });
+    if (evicted.empty()) return;
+
+    read_ahead_.clear();
+    drop_next_chunk_ = paginating_;
+    show_next_chunk_ = false;
+    history_exhausted_ = false;
+    const auto [created_at, id] =
+        *std::max_element(evicted.cbegin(), evicted.cend());
+    page_cursor_ = {id + 1, created_at};
+}
+
+qint64 VideoListModel::page_size() const { return page_size_; }
+
+void VideoListModel::setVisibleRows(const int rows) {
+    visible_rows_ = std::max(rows, 0);
+    update_page_size();
+}
+
+/* Shows the next page of older history. It's handed over right away if
+   prefetch() already read it ahead, otherwise it's shown once it arrives.
+ */
+void VideoListModel::paginate() {
+    if (read_ahead_.empty()) {
+        show_next_chunk_ = true;
+        request_chunk();
+        return;
+    }
+
+    const qsizetype count = std::min<qsizetype>(page_size_, read_ahead_.size());
+    prependVideos(read_ahead_.sliced(read_ahead_.size() - count));
+    read_ahead_.remove(read_ahead_.size() - count, count);
+
+    // Still at the loaded edge
+    prefetch();
+}
+
+// Reads up to kReadAheadPages of older history in the background, e.g., when
+// the view is scrolled close to the loaded edge
+void VideoListModel::prefetch() {
+    if (read_ahead_.size() >= kReadAheadPages * page_size_) return;
+
+    request_chunk();
+}
+
+// The chunk arrives through on_chunk_fetched, so only one request is kept in
+// flight at a time
+void VideoListModel::request_chunk() {
+    if (paginating_ || history_exhausted_) return;
+    paginating_ = true;
+    requested_size_ = page_size_;
+    chunk_timer_.start();
+
+    if (page_cursor_.has_value()) {
+        db_.fetchChunk(page_cursor_->first, page_cursor_->second,
+                       requested_size_);
+    } else {
+        db_.fetchFirstChunk(requested_size_);
+    }
+}
+
+void VideoListModel::on_chunk_fetched(QList<ManagedVideoParts> parts) {
+    paginating_ = false;
+    if (std::exchange(drop_next_chunk_, false)) {
+        // Requested again from where the history was seeked to
+        if (show_next_chunk_) request_chunk();
+        return;
+    }
+
+    if (parts.size() < requested_size_) history_exhausted_ = true;
+
+    if (!parts.empty()) {
+        row_cost_ns_ = chunk_timer_.nsecsElapsed() / parts.size();
+        update_page_size();
+
+        // Oldest first
+        page_cursor_ = {parts.first().id, parts.first().created_at};
+    }
+
+    // Already shown by restoreDownloads()
+    parts.removeIf([this](const ManagedVideoParts& video) {
+        return restored_ids_.contains(video.id);
+    });
+
+    if (std::exchange(show_next_chunk_, false)) {
+        prependVideos(std::move(parts));
+        return;
+    }
+
+    read_ahead_ = std::move(parts) + read_ahead_;
+    prefetch();
+}
+
+/* Shows the history around created_at instead of from the newest end, e.g.,
+   to jump to a month. The videos added at or before it are paged through by
+   paginate() like usual, and the ones after it by paginateNewer(). Videos
+   that are being downloaded, or are about to be, are kept ahead of their
+   page.
+ */
+void VideoListModel::seekTo(const qint64 created_at) {
+    unload_history();
+
+    // Either way from created_at, which the older side includes
+    page_cursor_ = {std::numeric_limits<qint64>::max(), created_at};
+    newer_cursor_ = page_cursor_;
+
+    paginate();
+    paginateNewer();
+}
+
+// Unloads the rows that aren't pinned, along with what was read ahead, for
+// paging to start over
+void VideoListModel::unload_history() {
+    evict_rows([](qsizetype) { return true; });
+
+    read_ahead_.clear();
+    drop_next_chunk_ = paginating_;
+    drop_next_newer_chunk_ = paginating_newer_;
+    history_exhausted_ = false;
+}
+
+// Shows the history again from the newest end, e.g., once it's imported into
+// since the imported videos may land anywhere in it
+void VideoListModel::reload_history() {
+    unload_history();
+
+    page_cursor_.reset();
+    newer_cursor_.reset();
+
+    paginate();
+}
+
+/* Shows the next page of newer history, once it arrives, after a seekTo() or
+   once the newest rows were unloaded
+ */
+void VideoListModel::paginateNewer() {
+    if (!newer_cursor_.has_value()) return;
+    show_next_newer_chunk_ = true;
+
+    if (paginating_newer_) return;
+    paginating_newer_ = true;
+    requested_newer_size_ = page_size_;
+
+    db_.fetchNewerChunk(newer_cursor_->first, newer_cursor_->second,
+                        requested_newer_size_);
+}
+
+void VideoListModel::on_newer_chunk_fetched(QList<ManagedVideoParts> parts) {
+    paginating_newer_ = false;
+    if (std::exchange(drop_next_newer_chunk_, false)) {
+        // Requested again from where the history was seeked to
+        if (show_next_newer_chunk_) paginateNewer();
+        return;
+    }
+    show_next_newer_chunk_ = false;
+
+    // Oldest first, the newest end was reached if it's short
+    if (parts.size() < requested_newer_size_) {
+        newer_cursor_.reset();
+    } else {
+        newer_cursor_ = {parts.last().id, parts.last().created_at};
+    }
+
+    appendVideos(std::move(parts));
+    evict_oldest();
+}
+
+/* Shows the downloads left when the app last quit and queues them again, in
+   the order they were queued in. yt-dlp picks up the partial files they left
+   behind. They're shown ahead of their page of history, which skips them.
+ */
+void VideoListModel::restoreDownloads() { db_.fetchDownloadQueue(); }
+
+void VideoListModel::on_download_queue_fetched(QList<ManagedVideoParts> parts) {
+    QList<qint64> ids;
+    ids.reserve(parts.size());
+    for (const auto& video : std::as_const(parts)) {
+        ids << video.id;
+    }
+
+    appendVideos(std::move(parts));
+
+    for (const qint64 id : std::as_const(ids)) {
+        const qsizetype row = rows_.row_of(id);
+        if (row < 0) continue;
+
+        restored_ids_.insert(id);
+        if (rows_.state(row) != DownloadState::kAdded) continue;
+
+        // Queued right away to keep the order, its format was saved with it
+        ManagedVideo* const video = video_at(row);
+        if (video->selected_format().isEmpty()) {
+            request_download(video);
+        } else {
+            emit requestDownloadVideo(video);
+        }
+    }
+}
+
+/* Applies changes another instance made to the history as row insertions and
+   removals. Rows that are queued or downloading here are left as is. Videos
+   shown that are loaded with the same created_at came from this instance,
+   and ones outside of the loaded history arrive with their page instead.
+ */
+void VideoListModel::on_history_changed(QList<ManagedVideoParts> shown,
+                                        QList<qint64> removed) {
+    const QSet<qint64> removed_ids(removed.cbegin(), removed.cend());
+
+    const auto is_kept = [this, &removed_ids](const qsizetype row) {
+        return !removed_ids.contains(rows_.id(row)) ||
+               rows_.state(row) == DownloadState::kQueued ||
+               rows_.state(row) == DownloadState::kDownloading;
+    };
+
+    QHash<qint64, qint64> loaded_created_at;
+    for (qsizetype row = rows_.size() - 1; row >= 0;) {
+        if (is_kept(row)) {
+            loaded_created_at.insert(rows_.id(row), rows_.created_at(row));
+            --row;
+            continue;
+        }
+
+        // Removed rows next to each other go at once, e.g., when pruned
+        qsizetype first = row;
+        while (first > 0 && !is_kept(first - 1)) --first;
+
+        for (qsizetype removed_row = first; removed_row <= row; ++removed_row) {
+            pending_downloads_.remove(rows_.id(removed_row));
+        }
+
+        beginRemoveRows(QModelIndex(), static_cast<int>(first),
+                        static_cast<int>(row));
+        const QList<ManagedVideo*> videos = take_rows(first, row - first + 1);
+        endRemoveRows();
+
+        for (auto* const video : videos) {
+            video->deleteLater();
+        }
+        row = first - 1;
+    }
+
+    read_ahead_.removeIf([&removed_ids](const ManagedVideoParts& parts) {
+        return removed_ids.contains(parts.id);
+    });
+
+    shown.removeIf([this, &loaded_created_at](const ManagedVideoParts& parts) {
+        return loaded_created_at.value(parts.id, -1) == parts.created_at ||
+               is_unloaded(parts);
+    });
+
+    appendVideos(std::move(shown));
+}
+
+/* Videos added or restored. Ones that belong to history that isn't loaded
+   arrive with their page instead, e.g., added while newer rows are unloaded
+   or restored after their page was.
+ */
+void VideoListModel::on_videos_pushed(QList<ManagedVideoParts> parts) {
+    parts.removeIf([this](const ManagedVideoParts& video) {
+        return is_unloaded(video);
+    });
+
+    appendVideos(std::move(parts));
+}
+
+/* Whether the video is newer than the newest page loaded while newer_cursor_
+   is set, or older than the oldest page fetched while older history is left.
+   While the first page hasn't arrived, it may not hold the video, which is
+   shown right away instead.
+ */
+bool VideoListModel::is_unloaded(const ManagedVideoParts& video) const {
+    const std::pair key(video.created_at, video.id);
+
+    if (newer_cursor_.has_value() &&
+        key > std::pair(newer_cursor_->second, newer_cursor_->first)) {
+        return true;
+    }
+
+    return !history_exhausted_ && page_cursor_.has_value() &&
+           key < std::pair(page_cursor_->second, page_cursor_->first);
+}
+
+// Pruned videos aren't reported through historyChanged since this instance
+// pruned them
+void VideoListModel::on_videos_pruned(QList<qint64> ids) {
+    on_history_changed({}, std::move(ids));
+}
+
+/* Sizes pages to cover kScreensPerPage of the view so a tall window isn't
+   filled by several round trips and a small one doesn't fetch rows it won't
+   show. The size is then capped by how many rows the last chunk suggests can
+   arrive within kPageLatencyBudgetNs.
+ */
+void VideoListModel::update_page_size() {
+    qint64 page_size = visible_rows_ > 0 ? visible_rows_ * kScreensPerPage
+                                         : Database::kChunkSize;
+    if (row_cost_ns_ > 0) {
+        page_size = std::min(page_size, kPageLatencyBudgetNs / row_cost_ns_);
+    }
+    page_size = std::clamp(page_size, kMinPageSize, kMaxPageSize);
+
+    if (page_size == page_size_) return;
+    page_size_ = page_size;
+
+    // Left out of release builds like the rest of qInfo()
+    qInfo() << "[History] Page size" << page_size_ << "for" << visible_rows_
+            << "visible rows at" << row_cost_ns_ << "ns per row";
+}
+
+}  // namespace yd_gui
@@ -1,81 +1,270 @@
-#pragma once
-
-#include <qabstractanimation.h>
-#include <qabstractitemmodel.h>
-#include <qhash.h>
-#include <qlist.h>
-#include <qnamespace.h>
-#include <qobject.h>
-#include <qtmetamacros.h>
-#include <qtypes.h>
-#include <qvariant.h>
-
-#include <QtQmlIntegration>
-
-#include "database.h"
-#include "video.h"
-
-namespace yd_gui {
-
-class VideoListModel : public QAbstractListModel {
-    Q_OBJECT
-    QML_ELEMENT
-    QML_SINGLETON
-    QML_UNCREATABLE("")
-
-   public:
-    enum class VideoListModelRole {
-        kIdRole = Qt::UserRole,
-        kInfoRole,
-        kProgressRole,
-        kCreatedAtRole,
-        kSelectedFormatRole,
-        kDownloadThumbnail,
-        kState,
-    };
-
-    explicit VideoListModel(Database& db = Database::get(),
-                            QObject* parent = nullptr);
-
-    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
-
-    QVariant data(const QModelIndex& index,
-                  int role = Qt::DisplayRole) const override;
-
-    bool setData(const QModelIndex& index, const QVariant& value,
-                 int role = Qt::EditRole) override;
-
-    QHash<int, QByteArray> roleNames() const override;
-
-    QModelIndex find_video(ManagedVideo& video) const;
-
-    void update_video(ManagedVideo& video, const QList<int>& roles);
-
-    Q_INVOKABLE void removeVideo(int row);
-
-    Q_INVOKABLE void removeAllVideos();
-
-    Q_INVOKABLE void downloadVideo(int row);
-
-    Q_INVOKABLE void downloadAllVideos();
-
-    Q_INVOKABLE void cancelDownload(int row);
-
-    Q_INVOKABLE void cancelAllDownloads();
-
-   signals:
-    void requestDownloadVideo(ManagedVideo*);
-
-   public slots:
-    void prependVideos(QList<ManagedVideoParts>);
-
-    void appendVideos(QList<ManagedVideoParts>);
-
-    void paginate();
-
-   private:
-    QList<ManagedVideo*> videos_;
-    Database& db_;
-};
-
-}  // namespace yd_gui
+#pragma once
+
+#include <qabstractanimation.h>
+#include <qabstractitemmodel.h>
+#include <qelapsedtimer.h>
+#include <qhash.h>
+#include <qlist.h>
+#include <qnamespace.h>
+#include <qobject.h>
+#include <qset.h>
+#include <qstring.h>
+#include <qtimer.h>
+#include <qtmetamacros.h>
+#include <qtypes.h>
+#include <qvariant.h>
+
+#include <QtQmlIntegration>
+#include <functional>
+#include <optional>
+#include <utility>
+
+#include "database.h"
+#include "video.h"
+
+namespace yd_gui {
+
+/* VideoListModel's rows, one list per field so a row of history costs its
+   fields rather than a QObject. A row that's downloaded or edited also gets a
+   ManagedVideo, which then holds its fields instead, see
+   VideoListModel::video_at().
+   Each row's id maps to an ordinal, its row plus base_, so rows are found by
+   id in O(1). Prepending lowers base_ instead of renumbering every row, and
+   removing rows only renumbers the shorter side of them.
+ */
+class VideoRows {
+   public:
+    qsizetype size() const;
+
+    bool empty() const;
+
+    // Rows in the order of parts, ahead of or after the ones already here
+    void prepend(QList<ManagedVideoParts> parts);
+
+    void append(QList<ManagedVideoParts> parts);
+
+    void remove(qsizetype first, qsizetype count);
+
+    void clear();
+
+    // -1 if no row has it, O(1)
+    qsizetype row_of(qint64 id) const;
+
+    qint64 id(qsizetype row) const;
+    qint64 created_at(qsizetype row) const;
+    const VideoInfo& info(qsizetype row) const;
+    bool formats_loaded(qsizetype row) const;
+    float progress(qsizetype row) const;
+    const QString& selected_format(qsizetype row) const;
+    bool download_thumbnail(qsizetype row) const;
+    DownloadState state(qsizetype row) const;
+
+    // nullptr until set_video()
+    ManagedVideo* video(qsizetype row) const;
+
+    // What a ManagedVideo of the row is made from
+    ManagedVideoParts parts(qsizetype row) const;
+
+    void set_video(qsizetype row, ManagedVideo* video);
+
+   private:
+    // Fills in the selected format and download_thumbnail like ManagedVideo
+    static ManagedVideoParts resolved(ManagedVideoParts parts,
+                                      bool download_thumbnail);
+
+    QList<qint64> ids_;
+    QList<qint64> created_ats_;
+    QList<VideoInfo> infos_;  // emptied once the row has a video
+    QList<bool> formats_loaded_;
+    QList<float> progress_;
+    QList<QString> selected_formats_;
+    QList<bool> download_thumbnails_;
+    QList<DownloadState> states_;
+    QList<ManagedVideo*> videos_;
+    QHash<qint64, qint64> ordinals_;  // of each row by its id
+    qint64 base_ = 0;                 // ordinal of the first row
+};
+
+class VideoListModel : public QAbstractListModel {
+    Q_OBJECT
+    QML_ELEMENT
+    QML_SINGLETON
+    QML_UNCREATABLE("")
+
+   public:
+    enum class VideoListModelRole {
+        kIdRole = Qt::UserRole,
+        kInfoRole,
+        kProgressRole,
+        kCreatedAtRole,
+        kSelectedFormatRole,
+        kDownloadThumbnail,
+        kState,
+        kFormatsLoaded,
+    };
+
+    // Pages of older history prefetch() reads ahead of the loaded edge
+    static constexpr qsizetype kReadAheadPages = 2;
+
+    // Bounds of the history page size picked by setVisibleRows() and the
+    // measured page latency
+    static constexpr qint64 kMinPageSize = 10;
+    static constexpr qint64 kMaxPageSize = 200;
+
+    // Most rows kept loaded, besides ones being downloaded. Rows furthest from
+    // where the view is paging are unloaded past it.
+    static constexpr qsizetype kWindowRows = 1000;
+
+    // Removed videos freed per event loop iteration
+    static constexpr qsizetype kFreeBatchSize = 200;
+
+    // Screenfuls of rows a page should cover
+    static constexpr qint64 kScreensPerPage = 2;
+
+    // A page shouldn't take longer than this to arrive
+    static constexpr qint64 kPageLatencyBudgetNs = 50'000'000;
+
+    explicit VideoListModel(Database& db = Database::get(),
+                            QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+
+    QVariant data(const QModelIndex& index,
+                  int role = Qt::DisplayRole) const override;
+
+    bool setData(const QModelIndex& index, const QVariant& value,
+                 int role = Qt::EditRole) override;
+
+    QHash<int, QByteArray> roleNames() const override;
+
+    QModelIndex find_video(const ManagedVideo& video) const;
+
+    qint64 page_size() const;
+
+    void update_video(const ManagedVideo& video, const QList<int>& roles);
+
+    Q_INVOKABLE void removeVideo(int row);
+
+    Q_INVOKABLE void removeAllVideos();
+
+    Q_INVOKABLE void undoRemoveVideo();
+
+    Q_INVOKABLE void downloadVideo(int row);
+
+    Q_INVOKABLE void downloadAllVideos();
+
+    Q_INVOKABLE void cancelDownload(int row);
+
+    Q_INVOKABLE void cancelAllDownloads();
+
+    Q_INVOKABLE void loadFormats(int row);
+
+    Q_INVOKABLE void setVisibleRows(int rows);
+
+    Q_INVOKABLE void restoreDownloads();
+
+    Q_INVOKABLE void seekTo(qint64 created_at);
+
+   signals:
+    void requestDownloadVideo(ManagedVideo*);
+
+   public slots:
+    void prependVideos(QList<ManagedVideoParts>);
+
+    void appendVideos(QList<ManagedVideoParts>);
+
+    void paginate();
+
+    void prefetch();
+
+    void paginateNewer();
+
+    void flushUpdates();
+
+   private:
+    void request_chunk();
+
+    void on_chunk_fetched(QList<ManagedVideoParts> parts);
+
+    void on_newer_chunk_fetched(QList<ManagedVideoParts> parts);
+
+    void update_page_size();
+
+    void trim_removed_ids();
+
+    void free_removed_videos();
+
+    void request_formats(qint64 id, bool formats_loaded);
+
+    void request_download(ManagedVideo* video);
+
+    void on_formats_fetched(qint64 id, QList<VideoFormat> formats);
+
+    void on_download_queue_fetched(QList<ManagedVideoParts> parts);
+
+    void on_history_changed(QList<ManagedVideoParts> shown,
+                            QList<qint64> removed);
+
+    void on_videos_pruned(QList<qint64> ids);
+
+    void on_videos_pushed(QList<ManagedVideoParts> parts);
+
+    bool is_unloaded(const ManagedVideoParts& video) const;
+
+    void reload_history();
+
+    void unload_history();
+
+    ManagedVideo* make_video(ManagedVideoParts parts);
+
+    ManagedVideo* video_at(qsizetype row);
+
+    ManagedVideo* take_row(qsizetype row);
+
+    QList<ManagedVideo*> take_rows(qsizetype first, qsizetype count);
+
+    bool is_pinned(qsizetype row) const;
+
+    QList<std::pair<qint64, qint64>> evict_rows(
+        const std::function<bool(qsizetype)>& is_evicted);
+
+    std::optional<std::pair<qint64, qint64>> window_bound(bool newest) const;
+
+    void evict_newest();
+
+    void evict_oldest();
+
+    VideoRows rows_;
+    Database& db_;
+    bool paginating_;  // whether a chunk was requested and hasn't arrived yet
+    bool paginating_newer_;   // likewise for a newer chunk
+    bool show_next_chunk_;    // paginate() is waiting on the next chunk
+    bool show_next_newer_chunk_;  // paginateNewer() is waiting on one
+    bool drop_next_chunk_;    // the chunk in flight is stale
+    bool drop_next_newer_chunk_;  // the newer chunk in flight is stale
+    bool history_exhausted_;  // no older history is left to fetch
+    QList<ManagedVideoParts> read_ahead_;  // older than rows_, oldest first
+    // (id, created_at) of the oldest video fetched, where the next page starts
+    std::optional<std::pair<qint64, qint64>> page_cursor_;
+    // (id, created_at) of the newest video fetched, where the next newer page
+    // starts. Only set while newer history is left after a seekTo().
+    std::optional<std::pair<qint64, qint64>> newer_cursor_;
+    qint64 visible_rows_;        // rows the view fits, 0 until it's known
+    qint64 page_size_;           // rows per page of history
+    qint64 requested_size_;      // page size of the chunk in flight
+    qint64 requested_newer_size_;  // page size of the newer chunk in flight
+    qint64 row_cost_ns_;         // fetch latency per row of the last chunk
+    QElapsedTimer chunk_timer_;  // started when the chunk was requested
+    QSet<qint64> formats_requested_;  // ids whose formats haven't arrived yet
+    QSet<qint64> pending_downloads_;  // ids to download once formats arrive
+    // (id, when it was removed), most recently removed last
+    QList<std::pair<qint64, qint64>> removed_ids_;
+    QSet<qint64> restored_ids_;       // shown ahead of their page
+    QList<ManagedVideo*> removed_videos_;  // waiting on free_timer_ to be freed
+    QTimer free_timer_;
+    // Roles changed by update_video(), waiting on update_timer_
+    QHash<const ManagedVideo*, QList<int>> pending_updates_;
+    QTimer update_timer_;
+};
+
+}  // namespace yd_gui
@@ -41,18 +41,32 @@ void VideoListModelSortedProxy::cancelDownload(int row) {
     source_model_->cancelDownload(mapToSource(proxy_index).row());
 }
 
+void VideoListModelSortedProxy::loadFormats(int row) {
+    if (!hasIndex(row, 0)) return;
+    QModelIndex proxy_index = index(row, 0);
+    source_model_->loadFormats(mapToSource(proxy_index).row());
+}
+
+// Ordered by when videos were added. Re-added videos keep their id but have
+// their created_at bumped.
 bool VideoListModelSortedProxy::lessThan(
     const QModelIndex& source_left, const QModelIndex& source_right) const {
-    const QVariant left_data = sourceModel()->data(
-        source_left,
-        static_cast<int>(VideoListModel::VideoListModelRole::kIdRole));
-    const QVariant right_data = sourceModel()->data(
-        source_right,
-        static_cast<int>(VideoListModel::VideoListModelRole::kIdRole));
+    const auto data = [this](const QModelIndex& index,
+                             VideoListModel::VideoListModelRole role) {
+        const QVariant value =
+            sourceModel()->data(index, static_cast<int>(role));
+        assert(value.typeId() == QMetaType::LongLong);
+        return value.toLongLong();
+    };
 
-    assert(left_data.typeId() == QMetaType::LongLong &&
-           right_data.typeId() == QMetaType::LongLong);
+    const qint64 left_created_at =
+        data(source_left, VideoListModel::VideoListModelRole::kCreatedAtRole);
+    const qint64 right_created_at =
+        data(source_right, VideoListModel::VideoListModelRole::kCreatedAtRole);
+    if (left_created_at != right_created_at)
+        return left_created_at < right_created_at;
 
-    return left_data.toLongLong() < right_data.toLongLong();
+    return data(source_left, VideoListModel::VideoListModelRole::kIdRole) <
+           data(source_right, VideoListModel::VideoListModelRole::kIdRole);
 }
 }  // namespace yd_gui
@@ -23,6 +23,8 @@ class VideoListModelSortedProxy : public QSortFilterProxyModel {
 
     Q_INVOKABLE void cancelDownload(int row);
 
+    Q_INVOKABLE void loadFormats(int row);
+
    protected:
     bool lessThan(const QModelIndex& source_left,
                   const QModelIndex& source_right) const override;
@@ -0,0 +1,129 @@
+#include "video_search_model.h"
+
+#include <qabstractitemmodel.h>
+#include <qbytearray.h>
+#include <qobject.h>
+#include <qtypes.h>
+#include <qvariant.h>
+
+#include <limits>
+#include <utility>
+
+#include "database.h"
+#include "video.h"
+
+namespace yd_gui {
+VideoSearchModel::VideoSearchModel(Database& db, QObject* parent)
+    : QAbstractListModel(parent),
+      db_(db),
+      pending_cursor_(0, 0),
+      searching_(false),
+      exhausted_(true) {
+    QObject::connect(&db_, &Database::searchFetched, this,
+                     &VideoSearchModel::on_search_fetched);
+}
+
+int VideoSearchModel::rowCount(const QModelIndex& parent) const {
+    if (parent.isValid()) return 0;
+    return results_.size();
+}
+
+QVariant VideoSearchModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || !hasIndex(index.row(), index.column()))
+        return QVariant();
+
+    const ManagedVideoParts& parts = results_.at(index.row());
+
+    switch (static_cast<VideoSearchModelRole>(role)) {
+        case VideoSearchModelRole::kIdRole:
+            return parts.id;
+        case VideoSearchModelRole::kInfoRole:
+            return QVariant::fromValue(parts.info);
+        case VideoSearchModelRole::kCreatedAtRole:
+            return parts.created_at;
+        default:
+            return QVariant();
+    }
+}
+
+QHash<int, QByteArray> VideoSearchModel::roleNames() const {
+    static const QHash<int, QByteArray> kRoles{
+        {static_cast<int>(VideoSearchModelRole::kIdRole), "dbId"},
+        {static_cast<int>(VideoSearchModelRole::kInfoRole), "info"},
+        {static_cast<int>(VideoSearchModelRole::kCreatedAtRole),
+         "createdAt"}};
+    return kRoles;
+}
+
+bool VideoSearchModel::canFetchMore(const QModelIndex& parent) const {
+    return !parent.isValid() && !searching_ && !exhausted_;
+}
+
+void VideoSearchModel::fetchMore(const QModelIndex& parent) {
+    if (!canFetchMore(parent)) return;
+
+    if (results_.empty()) {
+        request_page(std::numeric_limits<qint64>::max(),
+                     std::numeric_limits<qint64>::max());
+    } else {
+        request_page(results_.last().id, results_.last().created_at);
+    }
+}
+
+const QString& VideoSearchModel::text() const { return text_; }
+
+bool VideoSearchModel::searching() const { return searching_; }
+
+void VideoSearchModel::setText(QString text) {
+    if (text == text_) return;
+    text_ = std::move(text);
+    emit textChanged();
+
+    beginResetModel();
+    results_.clear();
+    endResetModel();
+
+    exhausted_ = text_.simplified().isEmpty();
+    set_searching(false);  // Any page in flight is now stale
+
+    if (!exhausted_) {
+        request_page(std::numeric_limits<qint64>::max(),
+                     std::numeric_limits<qint64>::max());
+    }
+}
+
+void VideoSearchModel::request_page(const qint64 before_id,
+                                    const qint64 before_created_at) {
+    pending_cursor_ = {before_id, before_created_at};
+    set_searching(true);
+
+    db_.searchVideos(text_, before_id, before_created_at);
+}
+
+void VideoSearchModel::on_search_fetched(const QString& text,
+                                         const qint64 before_id,
+                                         const qint64 before_created_at,
+                                         QList<ManagedVideoParts> parts) {
+    // Drop pages of a previous search
+    if (!searching_ || text != text_ ||
+        std::pair(before_id, before_created_at) != pending_cursor_)
+        return;
+
+    set_searching(false);
+    exhausted_ = parts.size() < Database::kChunkSize;
+
+    if (parts.empty()) return;
+
+    beginInsertRows(QModelIndex(), results_.size(),
+                    results_.size() + parts.size() - 1);
+    results_.append(std::move(parts));
+    endInsertRows();
+}
+
+void VideoSearchModel::set_searching(const bool searching) {
+    if (searching == searching_) return;
+    searching_ = searching;
+    emit searchingChanged();
+}
+
+}  // namespace yd_gui
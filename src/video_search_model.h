@@ -0,0 +1,83 @@
+#pragma once
+
+#include <qabstractitemmodel.h>
+#include <qhash.h>
+#include <qlist.h>
+#include <qnamespace.h>
+#include <qobject.h>
+#include <qtmetamacros.h>
+#include <qtypes.h>
+#include <qvariant.h>
+
+#include <QtQmlIntegration>
+#include <utility>
+
+#include "database.h"
+#include "video.h"
+
+namespace yd_gui {
+
+// Results of a full-text search over the history's titles and authors, from
+// newest to oldest like VideoListModel. Further pages are loaded through
+// fetchMore().
+class VideoSearchModel : public QAbstractListModel {
+    Q_OBJECT
+    QML_ELEMENT
+    QML_SINGLETON
+    QML_UNCREATABLE("")
+
+    Q_PROPERTY(QString text READ text WRITE setText NOTIFY textChanged)
+    Q_PROPERTY(bool searching READ searching NOTIFY searchingChanged)
+
+   public:
+    enum class VideoSearchModelRole {
+        kIdRole = Qt::UserRole,
+        kInfoRole,
+        kCreatedAtRole,
+    };
+
+    explicit VideoSearchModel(Database& db = Database::get(),
+                              QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+
+    QVariant data(const QModelIndex& index,
+                  int role = Qt::DisplayRole) const override;
+
+    QHash<int, QByteArray> roleNames() const override;
+
+    bool canFetchMore(const QModelIndex& parent) const override;
+
+    void fetchMore(const QModelIndex& parent) override;
+
+    const QString& text() const;
+
+    bool searching() const;
+
+   signals:
+    void textChanged();
+
+    void searchingChanged();
+
+   public slots:
+    void setText(QString text);
+
+   private:
+    void request_page(qint64 before_id, qint64 before_created_at);
+
+    void on_search_fetched(const QString& text, qint64 before_id,
+                           qint64 before_created_at,
+                           QList<ManagedVideoParts> parts);
+
+    void set_searching(bool searching);
+
+    QList<ManagedVideoParts> results_;
+    Database& db_;
+    QString text_;
+    // (id, created_at) cursor of the page in flight
+    std::pair<qint64, qint64> pending_cursor_;
+    bool searching_;  // whether a page is in flight
+    bool exhausted_;  // whether the last page was the final one
+};
+
+}  // namespace yd_gui
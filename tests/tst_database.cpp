@@ -1,12 +1,14 @@
 #include <database.h>
 #include <downloader.h>
 #include <gtest/gtest.h>
+#include <qbytearray.h>
 #include <qcontainerfwd.h>
 #include <qlist.h>
 #include <qsignalspy.h>
 #include <qtypes.h>
 
 #include <QDateTime>
+#include <QFile>
 #include <QObject>
 #include <QSignalSpy>
 #include <QSqlDatabase>
@@ -15,9 +17,13 @@
 #include <QSqlRecord>
 #include <QString>
 #include <QStringBuilder>
+#include <QTemporaryDir>
+#include <QThread>
 #include <QtTypes>
+#include <array>
 #include <iostream>
 #include <limits>
+#include <memory>
 #include <utility>
 
 #include "_tst_util.h"  // IWYU pragma: keep
@@ -44,10 +50,12 @@ class DatabaseTest : public testing::Test {
         return QSqlQuery(QSqlDatabase::database(connection_name_));
     }
 
+    // Removed videos waiting to be purged aren't counted
     qint64 rows_in_videos() {
         QSqlQuery query = make_query();
 
-        EXPECT_TRUE(query.exec("SELECT COUNT(*) FROM videos;") &&
+        EXPECT_TRUE(query.exec("SELECT COUNT(*) FROM videos "
+                               "WHERE removed_at IS NULL;") &&
                     query.next() && query.value(0).canConvert<qint64>())
             << "Failed to fetch videos row count";
 
@@ -58,18 +66,20 @@ class DatabaseTest : public testing::Test {
     constexpr static auto kVideosColumns{
         " id, created_at, video_id, title, author, seconds, thumbnail, url, "
         "audio_available "};
-    constexpr static auto kFormatsColumns{
-        " id, format_id, container, width, height, fps, videos_id "};
 
     // Check ManagedVideo Components are in increasing order
     static void EXPECT_PARTS_ASC(const QList<ManagedVideoParts>& chunk) {
         const ManagedVideoParts& first_parts = chunk.first();
 
-        auto [last_id, last_created_at, last_info, last_state] = first_parts;
+        auto [last_id, last_created_at, last_info, last_state,
+              last_formats_loaded, last_progress, last_selected_format,
+              last_download_thumbnail] = first_parts;
         for (const auto& parts : chunk) {
             if (parts == first_parts) continue;  // Skip first parts;
 
-            const auto& [id, created_at, info, state] = parts;
+            const auto& [id, created_at, info, state, formats_loaded,
+                         progress, selected_format, download_thumbnail] =
+                parts;
 
             EXPECT_GT(id, last_id) << "Parts were not ordered by increasing id";
             EXPECT_GE(created_at, last_created_at)
@@ -120,27 +130,14 @@ class DatabaseTest : public testing::Test {
                                  const qint64 expected_videos_id) {
         QSqlQuery query = make_query();
 
-        EXPECT_TRUE(query.prepare(QString("SELECT") % kFormatsColumns %
-                                  "FROM formats "
-                                  "WHERE videos_id = :videos_id;"));
+        EXPECT_TRUE(query.prepare("SELECT formats "
+                                  "FROM videos "
+                                  "WHERE id = :videos_id;"));
         query.bindValue(":videos_id", expected_videos_id);
-        query.setForwardOnly(true);
-        EXPECT_TRUE(query.exec()) << "Query failed";
-
-        QList<VideoFormat> formats;
-        while (query.next()) {
-            auto format_id = try_convert<QString>(query.value(1));
-            auto container = try_convert<QString>(query.value(2));
-            const auto width = try_convert<quint32>(query.value(3));
-            const auto height = try_convert<quint32>(query.value(4));
-            const auto fps = try_convert<float>(query.value(5));
-            const auto videos_id = try_convert<qint64>(query.value(6));
-
-            EXPECT_EQ(videos_id, expected_videos_id);
-
-            formats << VideoFormat(std::move(format_id), std::move(container),
-                                   width, height, fps);
-        }
+        EXPECT_TRUE(query.exec() && query.next()) << "Query failed";
+
+        const QList<VideoFormat> formats = VideoInfo::unpack_formats(
+            try_convert<QByteArray>(query.value(0)));
 
         EXPECT_THAT(formats, ContainerEq(expected_formats));
     }
@@ -166,7 +163,8 @@ class DatabaseTest : public testing::Test {
                                       const qint64 expected_id,
                                       const quint32 before_add,
                                       const quint32 after_add) {
-        const auto& [id, created_at, info, state] = parts;
+        const auto& [id, created_at, info, state, formats_loaded, progress,
+                     selected_format, download_thumbnail] = parts;
 
         EXPECT_EQ(id, expected_id);
         EXPECT_THAT(created_at, IsBetween(before_add, after_add));
@@ -174,6 +172,14 @@ class DatabaseTest : public testing::Test {
         EXPECT_EQ(state, DownloadState::kAdded);
     }
 
+    // Videos without a video_id aren't deduplicated, so they can be added
+    // more than once
+    static VideoInfo without_video_id(const VideoInfo& info) {
+        return VideoInfo("", info.title(), info.author(), info.seconds(),
+                         info.thumbnail(), info.url(), info.formats(),
+                         info.audio_available());
+    }
+
     VideoInfo info1_{"info1",
                      "title1",
                      "author1",
@@ -221,8 +227,8 @@ TEST_F(DatabaseTest, FetchFirstChunkTwoVideosInDb) {
     const auto chunk = db_.fetch_first_chunk();
     EXPECT_EQ(chunk.size(), 2);
 
-    EXPECT_EQ(chunk[0].info, info1_);
-    EXPECT_EQ(chunk[1].info, info2_);
+    EXPECT_INFOS_EQ_EXCLUDING_FORMATS(chunk[0].info, info1_);
+    EXPECT_INFOS_EQ_EXCLUDING_FORMATS(chunk[1].info, info2_);
 
     {
         SCOPED_TRACE("");
@@ -233,15 +239,18 @@ TEST_F(DatabaseTest, FetchFirstChunkTwoVideosInDb) {
 TEST_F(DatabaseTest, FetchFirstChunkMoreVideosinDbThanChunkSize) {
     for (std::remove_const<decltype(Database::kChunkSize)>::type i = 0;
          i < Database::kChunkSize; ++i) {
-        db_.addVideo(info1_);
+        db_.addVideo(without_video_id(info1_));
     }
     // Add one more over the chunk size
     db_.addVideo(info2_);
 
     const auto chunk = db_.fetch_first_chunk();
 
-    EXPECT_EQ(ManagedVideo(chunk.last()).info(), info2_)
-        << "Last video should be the most recently added";
+    {
+        SCOPED_TRACE("Last video should be the most recently added");
+        EXPECT_INFOS_EQ_EXCLUDING_FORMATS(ManagedVideo(chunk.last()).info(),
+                                          info2_);
+    }
 
     EXPECT_EQ(chunk.size(), Database::kChunkSize);
 
@@ -251,6 +260,53 @@ TEST_F(DatabaseTest, FetchFirstChunkMoreVideosinDbThanChunkSize) {
     }
 }
 
+TEST_F(DatabaseTest, FetchChunksOfGivenSize) {
+    constexpr qint64 kSize = 3;
+    for (qint64 i = 0; i < 2 * kSize + 1; ++i) {
+        db_.addVideo(without_video_id(info1_));
+    }
+
+    const auto first_chunk = db_.fetch_first_chunk(kSize);
+    ASSERT_EQ(first_chunk.size(), kSize);
+
+    const auto second_chunk = db_.fetch_chunk(
+        first_chunk.first().id, first_chunk.first().created_at, kSize);
+    ASSERT_EQ(second_chunk.size(), kSize);
+    EXPECT_LT(second_chunk.last().id, first_chunk.first().id);
+
+    const auto last_chunk = db_.fetch_chunk(
+        second_chunk.first().id, second_chunk.first().created_at, kSize);
+    EXPECT_EQ(last_chunk.size(), 1);
+}
+
+TEST_F(DatabaseTest, FetchChunksAroundTime) {
+    for (qint64 i = 0; i < 6; ++i) {
+        db_.addVideo(without_video_id(info1_));
+    }
+    EXPECT_TRUE(query_.exec("UPDATE videos SET created_at = id * 10;"));
+
+    // Seeking to 35 from both sides
+    constexpr auto kMax = std::numeric_limits<qint64>::max();
+    const auto older = db_.fetch_chunk(kMax, 35, 2);
+    ASSERT_EQ(older.size(), 2);
+    EXPECT_EQ(older.first().id, 2);
+    EXPECT_EQ(older.last().id, 3);
+
+    const auto newer = db_.fetch_newer_chunk(kMax, 35, 2);
+    ASSERT_EQ(newer.size(), 2);
+    EXPECT_EQ(newer.first().id, 4);
+    EXPECT_EQ(newer.last().id, 5);
+    {
+        SCOPED_TRACE("");
+        EXPECT_PARTS_ASC(newer);
+    }
+
+    const auto newest = db_.fetch_newer_chunk(newer.last().id,
+                                              newer.last().created_at, 2);
+    ASSERT_EQ(newest.size(), 1);
+    EXPECT_EQ(newest.first().id, 6);
+}
+
 TEST_F(DatabaseTest, FetchChunkNoVideosInDb) {
     const auto chunk = db_.fetch_chunk(0, 0);
 
@@ -265,8 +321,8 @@ TEST_F(DatabaseTest, FetchChunkTwoVideosInDbGetBoth) {
     const auto chunk = db_.fetch_chunk(kMax, kMax);
     EXPECT_EQ(chunk.size(), 2);
 
-    EXPECT_EQ(chunk[0].info, info1_);
-    EXPECT_EQ(chunk[1].info, info2_);
+    EXPECT_INFOS_EQ_EXCLUDING_FORMATS(chunk[0].info, info1_);
+    EXPECT_INFOS_EQ_EXCLUDING_FORMATS(chunk[1].info, info2_);
 
     {
         SCOPED_TRACE("");
@@ -275,13 +331,16 @@ TEST_F(DatabaseTest, FetchChunkTwoVideosInDbGetBoth) {
 }
 
 TEST_F(DatabaseTest, FetchSecondChunk) {
+    const VideoInfo info1 = without_video_id(info1_);
+    const VideoInfo info2 = without_video_id(info2_);
+
     for (std::remove_const<decltype(Database::kChunkSize)>::type i = 0;
          i < Database::kChunkSize; ++i) {
-        db_.addVideo(info1_);
+        db_.addVideo(info1);
     }
     for (std::remove_const<decltype(Database::kChunkSize)>::type i = 0;
          i < Database::kChunkSize; ++i) {
-        db_.addVideo(info2_);
+        db_.addVideo(info2);
     }
 
     const auto first_chunk = db_.fetch_first_chunk();
@@ -290,12 +349,13 @@ TEST_F(DatabaseTest, FetchSecondChunk) {
     for (qsizetype i = 0; i < first_chunk.size(); ++i) {
         const auto& parts = first_chunk[i];
         EXPECT_EQ(parts.id, i + Database::kChunkSize + 1);
-        EXPECT_EQ(parts.info, info2_);
+        EXPECT_INFOS_EQ_EXCLUDING_FORMATS(parts.info, info2);
     }
 
     // Destructure oldest part from first chunk
-    const auto& [last_id, last_created_at, last_info, last_state] =
-        first_chunk.first();
+    const auto& [last_id, last_created_at, last_info, last_state,
+                 last_formats_loaded, last_progress, last_selected_format,
+                 last_download_thumbnail] = first_chunk.first();
 
     const auto second_chunk = db_.fetch_chunk(last_id, last_created_at);
     EXPECT_EQ(second_chunk.size(), Database::kChunkSize);
@@ -303,8 +363,297 @@ TEST_F(DatabaseTest, FetchSecondChunk) {
     for (qsizetype i = 0; i < second_chunk.size(); ++i) {
         const auto& part = second_chunk[i];
         EXPECT_EQ(part.id, i + 1);
-        EXPECT_EQ(part.info, info1_);
+        EXPECT_INFOS_EQ_EXCLUDING_FORMATS(part.info, info1);
+    }
+}
+
+TEST_F(DatabaseTest, FetchFirstChunkAsync) {
+    db_.addVideo(info1_);
+    db_.addVideo(info2_);
+
+    QSignalSpy chunk_spy(&db_, &Database::chunkFetched);
+    db_.fetchFirstChunk();
+
+    ASSERT_EQ(chunk_spy.count(), 1);
+    const auto chunk = try_convert<QList<ManagedVideoParts>>(
+        chunk_spy.takeFirst().takeFirst());
+    EXPECT_EQ(chunk, db_.fetch_first_chunk());
+}
+
+TEST_F(DatabaseTest, FetchChunkAsync) {
+    db_.addVideo(info1_);
+    db_.addVideo(info2_);
+
+    QSignalSpy chunk_spy(&db_, &Database::chunkFetched);
+    db_.fetchChunk(2, std::numeric_limits<qint64>::max());
+
+    ASSERT_EQ(chunk_spy.count(), 1);
+    const auto chunk = try_convert<QList<ManagedVideoParts>>(
+        chunk_spy.takeFirst().takeFirst());
+    ASSERT_EQ(chunk.size(), 1);
+    EXPECT_INFOS_EQ_EXCLUDING_FORMATS(chunk.first().info, info1_);
+}
+
+TEST_F(DatabaseTest, AddVideoFromOtherThreadIsForwarded) {
+    const std::unique_ptr<QThread> caller(
+        QThread::create([this] { db_.addVideo(info1_); }));
+    caller->start();
+    caller->wait();
+
+    // Forwarded to this thread, so it hasn't run yet
+    EXPECT_EQ(video_spy_.count(), 0);
+    EXPECT_EQ(rows_in_videos(), 0);
+
+    EXPECT_TRUE(wait_for_n_signals(video_spy_, 1));
+    EXPECT_EQ(rows_in_videos(), 1);
+}
+
+TEST_F(DatabaseTest, FetchedChunkLeavesFormatsOut) {
+    db_.addVideo(info2_);
+
+    const auto chunk = db_.fetch_first_chunk();
+    ASSERT_EQ(chunk.size(), 1);
+    EXPECT_FALSE(chunk.first().formats_loaded);
+    EXPECT_TRUE(chunk.first().info.formats().empty());
+}
+
+TEST_F(DatabaseTest, FetchFormats) {
+    db_.addVideos({info1_, info2_});
+
+    EXPECT_THAT(db_.fetch_formats(2), ContainerEq(info2_.formats()));
+}
+
+TEST_F(DatabaseTest, FetchFormatsOfMissingVideo) {
+    EXPECT_TRUE(db_.fetch_formats(1).empty());
+}
+
+TEST_F(DatabaseTest, FetchFormatsAsync) {
+    db_.addVideo(info2_);
+
+    QSignalSpy formats_spy(&db_, &Database::formatsFetched);
+    db_.fetchFormats(1);
+
+    ASSERT_EQ(formats_spy.count(), 1);
+    const auto arguments = formats_spy.takeFirst();
+    EXPECT_EQ(try_convert<qint64>(arguments[0]), 1);
+    EXPECT_THAT(try_convert<QList<VideoFormat>>(arguments[1]),
+                ContainerEq(info2_.formats()));
+}
+
+TEST(DatabasePragmasTest, AppliedOnOpen) {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+
+    const QString connection_name = QString::fromStdString(test_name());
+    {
+        Database db = Database::get_temp(connection_name,
+                                         dir.filePath("history.db"),
+                                         {.journal_mode = "WAL",
+                                          .synchronous = "NORMAL",
+                                          .mmap_size = 1024 * 1024,
+                                          .cache_size_kib = 1024,
+                                          .busy_timeout_ms = 1234});
+        EXPECT_TRUE(db.valid());
+
+        QSqlQuery query(QSqlDatabase::database(connection_name));
+        const auto pragma = [&query](const QString& name) {
+            EXPECT_TRUE(query.exec("PRAGMA " % name % ";") && query.next());
+            return query.value(0);
+        };
+
+        EXPECT_EQ(try_convert<QString>(pragma("journal_mode")), "wal");
+        // NORMAL
+        EXPECT_EQ(try_convert<qint64>(pragma("synchronous")), 1);
+        EXPECT_EQ(try_convert<qint64>(pragma("mmap_size")), 1024 * 1024);
+        EXPECT_EQ(try_convert<qint64>(pragma("cache_size")), -1024);
+        EXPECT_EQ(try_convert<qint64>(pragma("busy_timeout")), 1234);
+    }
+    QSqlDatabase::removeDatabase(connection_name);
+}
+
+TEST(DatabaseReadConnectionTest, FetchFromOtherThreads) {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+
+    const QString connection_name = QString::fromStdString(test_name());
+    {
+        Database db =
+            Database::get_temp(connection_name, dir.filePath("history.db"));
+        ASSERT_TRUE(db.valid());
+
+        QList<VideoInfo> infos;
+        for (qint64 i = 0; i < Database::kChunkSize; ++i) {
+            infos << VideoInfo("video" % QString::number(i), "title", "author",
+                               1, "thumbnail", "url", {}, true);
+        }
+        db.addVideos(infos);
+        const auto expected = db.fetch_first_chunk();
+
+        // Each reads through a connection of its own
+        std::array<QList<ManagedVideoParts>, 2> chunks;
+        std::array<std::unique_ptr<QThread>, 2> threads;
+        for (size_t i = 0; i < threads.size(); ++i) {
+            threads[i].reset(QThread::create(
+                [&db, &chunk = chunks[i]] { chunk = db.fetch_first_chunk(); }));
+            threads[i]->start();
+        }
+        for (const auto& thread : threads) thread->wait();
+
+        for (const auto& chunk : chunks) EXPECT_EQ(chunk, expected);
     }
+    QSqlDatabase::removeDatabase(connection_name);
+}
+
+TEST_F(DatabaseTest, SearchByTitle) {
+    db_.addVideos({info1_, info2_});
+
+    const auto results = db_.search("title2");
+    ASSERT_EQ(results.size(), 1);
+    EXPECT_INFOS_EQ_EXCLUDING_FORMATS(results.first().info, info2_);
+}
+
+TEST_F(DatabaseTest, SearchByAuthorPrefix) {
+    db_.addVideos({info1_, info2_});
+
+    const auto results = db_.search("auth");
+    ASSERT_EQ(results.size(), 2);
+    // Newest first
+    EXPECT_INFOS_EQ_EXCLUDING_FORMATS(results[0].info, info2_);
+    EXPECT_INFOS_EQ_EXCLUDING_FORMATS(results[1].info, info1_);
+}
+
+TEST_F(DatabaseTest, SearchAllWordsMustMatch) {
+    db_.addVideos({info1_, info2_});
+
+    EXPECT_EQ(db_.search("title1 author1").size(), 1);
+    EXPECT_TRUE(db_.search("title1 author2").empty());
+}
+
+TEST_F(DatabaseTest, SearchIgnoresQueryOperators) {
+    db_.addVideo(info1_);
+
+    EXPECT_TRUE(db_.search("\"").empty());
+    EXPECT_TRUE(db_.search("title1 OR").empty());
+    EXPECT_TRUE(db_.search("   ").empty());
+}
+
+TEST_F(DatabaseTest, SearchPaginates) {
+    for (qint64 i = 0; i < Database::kChunkSize + 1; ++i) {
+        db_.addVideo(without_video_id(info1_));
+    }
+
+    const auto first_page = db_.search("title1");
+    ASSERT_EQ(first_page.size(), Database::kChunkSize);
+
+    const auto second_page = db_.search("title1", first_page.last().id,
+                                        first_page.last().created_at);
+    ASSERT_EQ(second_page.size(), 1);
+    EXPECT_EQ(second_page.first().id, 1);
+}
+
+// Like the history's pages, a video added again is moved to the top
+TEST_F(DatabaseTest, SearchOrderedByCreatedAt) {
+    db_.addVideos({info1_, info2_});
+    EXPECT_TRUE(query_.exec("UPDATE videos SET created_at = 0 WHERE id = 2;"));
+
+    const auto first_page = db_.search("auth");
+    ASSERT_EQ(first_page.size(), 2);
+    EXPECT_EQ(first_page[0].id, 1);
+    EXPECT_EQ(first_page[1].id, 2);
+
+    const auto second_page =
+        db_.search("auth", first_page[0].id, first_page[0].created_at);
+    ASSERT_EQ(second_page.size(), 1);
+    EXPECT_EQ(second_page.first().id, 2);
+}
+
+TEST_F(DatabaseTest, SearchSkipsRemovedVideos) {
+    db_.addVideos({info1_, info2_});
+
+    db_.removeVideo(1);
+
+    EXPECT_TRUE(db_.search("title1").empty());
+    EXPECT_EQ(db_.search("title2").size(), 1);
+}
+
+TEST_F(DatabaseTest, SearchVideosAsync) {
+    db_.addVideos({info1_, info2_});
+
+    QSignalSpy search_spy(&db_, &Database::searchFetched);
+    db_.searchVideos("title2", std::numeric_limits<qint64>::max(),
+                     std::numeric_limits<qint64>::max());
+
+    ASSERT_EQ(search_spy.count(), 1);
+    const auto arguments = search_spy.takeFirst();
+    EXPECT_EQ(arguments[0].toString(), "title2");
+    EXPECT_EQ(try_convert<QList<ManagedVideoParts>>(arguments[3]).size(), 1);
+}
+
+TEST_F(DatabaseTest, StatsOfEmptyHistory) {
+    const HistoryStats stats = db_.stats();
+
+    EXPECT_EQ(stats.videos, 0);
+    EXPECT_EQ(stats.seconds, 0);
+    EXPECT_TRUE(stats.authors.empty());
+    EXPECT_TRUE(stats.months.empty());
+}
+
+TEST_F(DatabaseTest, StatsCountAddedVideos) {
+    db_.addVideos({info1_, info2_, without_video_id(info2_)});
+
+    const HistoryStats stats = db_.stats();
+    EXPECT_EQ(stats.videos, 3);
+    EXPECT_EQ(stats.seconds, 5);
+    EXPECT_THAT(stats.authors,
+                ContainerEq(QList<HistoryStatsGroup>{{"author2", 2, 4},
+                                                     {"author1", 1, 1}}));
+
+    const QString month = QDateTime::currentDateTimeUtc().toString("yyyy-MM");
+    EXPECT_THAT(stats.months,
+                ContainerEq(QList<HistoryStatsGroup>{{month, 3, 5}}));
+}
+
+TEST_F(DatabaseTest, StatsFollowUpsertedVideo) {
+    db_.addVideo(info1_);
+    // Same video_id, but longer and by someone else
+    db_.addVideo(VideoInfo(info1_.video_id(), info1_.title(), "author2", 10,
+                           info1_.thumbnail(), info1_.url(), {}, false));
+
+    const HistoryStats stats = db_.stats();
+    EXPECT_EQ(stats.videos, 1);
+    EXPECT_EQ(stats.seconds, 10);
+    EXPECT_THAT(stats.authors,
+                ContainerEq(QList<HistoryStatsGroup>{{"author2", 1, 10}}));
+    ASSERT_EQ(stats.months.size(), 1);
+    EXPECT_EQ(stats.months.first().videos, 1);
+}
+
+TEST_F(DatabaseTest, StatsUncountRemovedVideos) {
+    db_.addVideos({info1_, info2_});
+
+    db_.removeVideo(1);
+    HistoryStats stats = db_.stats();
+    EXPECT_EQ(stats.videos, 1);
+    EXPECT_EQ(stats.seconds, 2);
+    EXPECT_THAT(stats.authors,
+                ContainerEq(QList<HistoryStatsGroup>{{"author2", 1, 2}}));
+
+    db_.removeAllVideos();
+    stats = db_.stats();
+    EXPECT_EQ(stats.videos, 0);
+    EXPECT_EQ(stats.seconds, 0);
+    EXPECT_TRUE(stats.authors.empty());
+    EXPECT_TRUE(stats.months.empty());
+}
+
+TEST_F(DatabaseTest, FetchStatsAsync) {
+    db_.addVideo(info1_);
+
+    QSignalSpy stats_spy(&db_, &Database::statsFetched);
+    db_.fetchStats();
+
+    ASSERT_EQ(stats_spy.count(), 1);
+    EXPECT_EQ(try_convert<HistoryStats>(stats_spy.takeFirst()[0]).videos, 1);
 }
 
 TEST_F(DatabaseTest, SetValidToTrue) {
@@ -410,6 +759,167 @@ TEST_F(DatabaseTest, AddTwoVideos) {
     }
 }
 
+TEST_F(DatabaseTest, AddVideosInOneBatch) {
+    db_.addVideos({info1_, info2_});
+
+    EXPECT_EQ(rows_in_videos(), 2);
+
+    ASSERT_EQ(video_spy_.count(), 1) << "Batch should be pushed once";
+    const auto parts = try_convert<QList<ManagedVideoParts>>(
+        video_spy_.takeFirst().takeFirst());
+
+    ASSERT_EQ(parts.size(), 2);
+    EXPECT_EQ(parts[0].info, info1_);
+    EXPECT_EQ(parts[1].info, info2_);
+    {
+        SCOPED_TRACE("");
+        EXPECT_PARTS_ASC(parts);
+    }
+}
+
+TEST_F(DatabaseTest, AddVideosEmpty) {
+    db_.addVideos({});
+
+    EXPECT_EQ(rows_in_videos(), 0);
+    EXPECT_EQ(video_spy_.count(), 0);
+}
+
+TEST_F(DatabaseTest, AddVideoBatchedGathersWindow) {
+    db_.addVideoBatched(info1_);
+    db_.addVideoBatched(info2_);
+    db_.addVideoBatched(without_video_id(info1_));
+
+    EXPECT_EQ(video_spy_.count(), 0) << "Should wait for the window to close";
+    EXPECT_EQ(rows_in_videos(), 0);
+
+    ASSERT_TRUE(wait_for_n_signals(video_spy_, 1));
+    EXPECT_EQ(rows_in_videos(), 3);
+
+    const auto parts = try_convert<QList<ManagedVideoParts>>(
+        video_spy_.takeFirst().takeFirst());
+    EXPECT_EQ(parts.size(), 3);
+}
+
+TEST_F(DatabaseTest, AddSameVideoTwiceUpserts) {
+    db_.addVideo(info1_);
+    db_.addVideo(info2_);
+
+    const VideoInfo refreshed("info1", "new title", "new author", 3,
+                              "new thumbnail", "new url",
+                              {VideoFormat{"format3", "mkv", 500, 600, 24}},
+                              true);
+    const auto before_add = QDateTime::currentSecsSinceEpoch();
+    db_.addVideo(refreshed);
+    const auto after_add = QDateTime::currentSecsSinceEpoch();
+
+    EXPECT_EQ(rows_in_videos(), 2);
+
+    ASSERT_TRUE(query_.exec(QString("SELECT") % kVideosColumns %
+                            "FROM videos "
+                            "WHERE id = 1;"));
+    ASSERT_TRUE(query_.next());
+    {
+        SCOPED_TRACE("");
+        EXPECT_QUERY_EQ_INFO_FORMATS(query_.record(), refreshed, 1, before_add,
+                                     after_add);
+    }
+
+    ASSERT_EQ(video_spy_.count(), 3);
+    const auto parts = try_convert<QList<ManagedVideoParts>>(
+        video_spy_.takeLast().takeFirst());
+    ASSERT_EQ(parts.size(), 1);
+    {
+        SCOPED_TRACE("");
+        EXPECT_PUSHED_EQ_INFO(parts.first(), refreshed, 1, before_add,
+                              after_add);
+    }
+}
+
+TEST_F(DatabaseTest, AddSameVideoTwiceInOneBatch) {
+    db_.addVideos({info1_, info1_});
+
+    EXPECT_EQ(rows_in_videos(), 1);
+    {
+        SCOPED_TRACE("");
+        EXPECT_QUERY_EQ_FORMATS(info1_.formats(), 1);
+    }
+}
+
+TEST(DatabaseMigrationTest, LegacyHistoryMigratedOnOpen) {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QString file_name = dir.filePath("history.db");
+
+    // History from before videos were deduplicated
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "legacy");
+        db.setDatabaseName(file_name);
+        ASSERT_TRUE(db.open());
+
+        QSqlQuery query(db);
+        ASSERT_TRUE(query.exec(
+            "CREATE TABLE videos ("
+            "    id INTEGER PRIMARY KEY AUTOINCREMENT,"
+            "    created_at INTEGER NOT NULL, video_id TEXT NOT NULL,"
+            "    title TEXT NOT NULL, author TEXT NOT NULL,"
+            "    seconds INTEGER NOT NULL, thumbnail TEXT NOT NULL,"
+            "    url TEXT NOT NULL, audio_available BOOLEAN NOT NULL);"));
+        ASSERT_TRUE(query.exec(
+            "CREATE TABLE formats ("
+            "    id INTEGER PRIMARY KEY AUTOINCREMENT,"
+            "    format_id TEXT NOT NULL, container TEXT NOT NULL,"
+            "    width INTEGER NOT NULL, height INTEGER NOT NULL,"
+            "    fps REAL NOT NULL, videos_id INTEGER NOT NULL,"
+            "    FOREIGN KEY (videos_id) REFERENCES videos (id) "
+            "    ON DELETE CASCADE);"));
+        ASSERT_TRUE(query.exec(
+            "INSERT INTO videos (created_at, video_id, title, author, seconds,"
+            "    thumbnail, url, audio_available) VALUES"
+            "    (1, 'a', 'old', '', 0, '', 'url', 0),"
+            "    (2, 'b', 'b', '', 0, '', 'url', 0),"
+            "    (3, 'a', 'new', '', 0, '', 'url', 0),"
+            "    (4, '', 'x', '', 0, '', 'url', 0),"
+            "    (5, '', 'x', '', 0, '', 'url', 0);"));
+        ASSERT_TRUE(query.exec(
+            "INSERT INTO formats (format_id, container, width, height, fps,"
+            "    videos_id) VALUES"
+            "    ('f1', 'mp4', 1, 2, 3, 1),"
+            "    ('f1', 'mp4', 1, 2, 3, 3), ('f2', 'webm', 4, 5, 6, 3);"));
+        db.close();
+    }
+    QSqlDatabase::removeDatabase("legacy");
+
+    const QString connection_name = QString::fromStdString(test_name());
+    {
+        Database db = Database::get_temp(connection_name, file_name);
+        EXPECT_TRUE(db.valid());
+
+        QSqlQuery query(QSqlDatabase::database(connection_name));
+        ASSERT_TRUE(query.exec("SELECT id FROM videos ORDER BY id;"));
+        QList<qint64> ids;
+        while (query.next()) ids << query.value(0).toLongLong();
+        EXPECT_THAT(ids, ContainerEq(QList<qint64>{2, 3, 4, 5}));
+
+        // Packed into their video
+        EXPECT_FALSE(query.exec("SELECT 1 FROM formats;"));
+
+        const QList<VideoFormat> expected_formats{
+            VideoFormat("f1", "mp4", 1, 2, 3),
+            VideoFormat("f2", "webm", 4, 5, 6)};
+        EXPECT_THAT(db.fetch_formats(3), ContainerEq(expected_formats));
+        EXPECT_TRUE(db.fetch_formats(2).empty());
+
+        // Counted when the stats were introduced
+        EXPECT_EQ(db.stats().videos, 4);
+
+        // Shown as downloaded like before their downloads were kept
+        for (const auto& parts : db.fetch_first_chunk()) {
+            EXPECT_EQ(parts.state, DownloadState::kComplete);
+        }
+    }
+    QSqlDatabase::removeDatabase(connection_name);
+}
+
 TEST_F(DatabaseTest, RemoveOnEmptyDb) {
     db_.removeVideo(1);  // Checked by error signal
 }
@@ -450,6 +960,7 @@ TEST_F(DatabaseTest, RemoveFirstOfTwoVideos) {
 
     EXPECT_TRUE(query_.exec(QString("SELECT") % kVideosColumns %
                             "FROM videos "
+                            "WHERE removed_at IS NULL "
                             "LIMIT 1;"));
     EXPECT_TRUE(query_.next());
 
@@ -476,6 +987,7 @@ TEST_F(DatabaseTest, RemoveSecondOfTwoVideos) {
 
     EXPECT_TRUE(query_.exec(QString("SELECT") % kVideosColumns %
                             "FROM videos "
+                            "WHERE removed_at IS NULL "
                             "LIMIT 1;"));
     EXPECT_TRUE(query_.next());
 
@@ -487,6 +999,374 @@ TEST_F(DatabaseTest, RemoveSecondOfTwoVideos) {
     }
 }
 
+TEST_F(DatabaseTest, RemovedVideoIsHidden) {
+    db_.addVideos({info1_, info2_});
+
+    db_.removeVideo(1);
+
+    const auto chunk = db_.fetch_first_chunk();
+    ASSERT_EQ(chunk.size(), 1);
+    EXPECT_EQ(chunk.first().id, 2);
+    EXPECT_EQ(db_.stats().videos, 1);
+}
+
+TEST_F(DatabaseTest, RestoreRemovedVideo) {
+    db_.addVideos({info1_, info2_});
+    db_.removeVideo(1);
+
+    QSignalSpy pushed_spy(&db_, &Database::videosPushed);
+    db_.restoreVideo(1);
+
+    ASSERT_EQ(pushed_spy.count(), 1);
+    const auto videos =
+        try_convert<QList<ManagedVideoParts>>(pushed_spy.takeFirst()[0]);
+    ASSERT_EQ(videos.size(), 1);
+    EXPECT_EQ(videos.first().id, 1);
+    EXPECT_INFOS_EQ_EXCLUDING_FORMATS(videos.first().info, info1_);
+
+    EXPECT_EQ(db_.fetch_first_chunk().size(), 2);
+    EXPECT_EQ(db_.stats().videos, 2);
+}
+
+TEST_F(DatabaseTest, RestoreVideoThatWasntRemoved) {
+    db_.addVideo(info1_);
+
+    QSignalSpy pushed_spy(&db_, &Database::videosPushed);
+    db_.restoreVideo(1);
+
+    EXPECT_EQ(pushed_spy.count(), 0);
+}
+
+TEST_F(DatabaseTest, ReaddedVideoIsRestored) {
+    db_.addVideo(info1_);
+    db_.removeVideo(1);
+
+    db_.addVideo(info1_);
+
+    const auto chunk = db_.fetch_first_chunk();
+    ASSERT_EQ(chunk.size(), 1);
+    EXPECT_EQ(chunk.first().id, 1);
+    EXPECT_EQ(db_.stats().videos, 1);
+}
+
+TEST_F(DatabaseTest, PurgeRemovedVideosAfterUndoWindow) {
+    db_.addVideos({info1_, info2_});
+    db_.removeVideo(1);
+    db_.removeVideo(2);
+
+    // Within the window
+    db_.purgeRemovedVideos();
+    EXPECT_TRUE(query_.exec("SELECT COUNT(*) FROM videos;") && query_.next());
+    EXPECT_EQ(query_.value(0).toLongLong(), 2);
+
+    EXPECT_TRUE(query_.exec("UPDATE videos SET removed_at = 0 WHERE id = 1;"));
+    db_.purgeRemovedVideos();
+    EXPECT_TRUE(query_.exec("SELECT id FROM videos;") && query_.next());
+    EXPECT_EQ(query_.value(0).toLongLong(), 2);
+    EXPECT_FALSE(query_.next());
+
+    // Not restorable anymore
+    QSignalSpy pushed_spy(&db_, &Database::videosPushed);
+    db_.restoreVideo(1);
+    EXPECT_EQ(pushed_spy.count(), 0);
+}
+
+TEST_F(DatabaseTest, SavedDownloadsAreWrittenBehind) {
+    db_.addVideo(info1_);
+
+    db_.saveDownload({.id = 1,
+                      .state = DownloadState::kDownloading,
+                      .progress = 0.25});
+    db_.saveDownload({.id = 1,
+                      .state = DownloadState::kDownloading,
+                      .progress = 0.5});
+
+    EXPECT_TRUE(query_.exec("SELECT progress FROM videos;") && query_.next());
+    EXPECT_EQ(query_.value(0).toFloat(), 0) << "Should wait for the window";
+
+    db_.flushDownloads();
+    EXPECT_TRUE(query_.exec("SELECT progress FROM videos;") && query_.next());
+    EXPECT_EQ(query_.value(0).toFloat(), 0.5);
+}
+
+TEST_F(DatabaseTest, FetchSavedDownload) {
+    db_.addVideos({info1_, info2_});
+    db_.saveDownload({.id = 2,
+                      .state = DownloadState::kComplete,
+                      .progress = 1,
+                      .selected_format = "format2",
+                      .download_thumbnail = true});
+    db_.flushDownloads();
+
+    const auto chunk = db_.fetch_first_chunk();
+    ASSERT_EQ(chunk.size(), 2);
+
+    // Never saved
+    EXPECT_EQ(chunk[0].state, DownloadState::kAdded);
+    EXPECT_EQ(chunk[0].progress, 0);
+    EXPECT_TRUE(chunk[0].selected_format.isEmpty());
+    EXPECT_EQ(chunk[0].download_thumbnail, std::nullopt);
+
+    EXPECT_EQ(chunk[1].state, DownloadState::kComplete);
+    EXPECT_EQ(chunk[1].progress, 1);
+    EXPECT_EQ(chunk[1].selected_format, "format2");
+    EXPECT_EQ(chunk[1].download_thumbnail, true);
+}
+
+TEST_F(DatabaseTest, InterruptedDownloadIsFetchedAsAdded) {
+    db_.addVideo(info1_);
+    db_.saveDownload({.id = 1,
+                      .state = DownloadState::kDownloading,
+                      .progress = 0.5});
+    db_.flushDownloads();
+
+    const auto chunk = db_.fetch_first_chunk();
+    ASSERT_EQ(chunk.size(), 1);
+    EXPECT_EQ(chunk.first().state, DownloadState::kAdded);
+    EXPECT_EQ(chunk.first().progress, 0.5);
+}
+
+TEST_F(DatabaseTest, ReaddedVideoStartsDownloadOver) {
+    db_.addVideo(info1_);
+    db_.saveDownload({.id = 1, .state = DownloadState::kComplete});
+    db_.flushDownloads();
+
+    db_.addVideo(info1_);
+
+    const auto chunk = db_.fetch_first_chunk();
+    ASSERT_EQ(chunk.size(), 1);
+    EXPECT_EQ(chunk.first().state, DownloadState::kAdded);
+}
+
+TEST_F(DatabaseTest, DownloadQueueKeepsOrder) {
+    db_.addVideos({info1_, info2_, without_video_id(info1_)});
+
+    db_.enqueueDownload(3);
+    db_.enqueueDownload(1);
+    db_.enqueueDownload(2);
+    db_.enqueueDownload(3);  // Keeps its place
+    db_.dequeueDownload(1);
+
+    QList<qint64> ids;
+    for (const auto& parts : db_.download_queue()) ids << parts.id;
+    EXPECT_THAT(ids, ContainerEq(QList<qint64>{3, 2}));
+}
+
+TEST_F(DatabaseTest, DownloadQueueLeavesOutRemovedVideos) {
+    db_.addVideos({info1_, info2_});
+    db_.enqueueDownload(1);
+    db_.enqueueDownload(2);
+
+    db_.removeVideo(1);
+
+    QSignalSpy queue_spy(&db_, &Database::downloadQueueFetched);
+    db_.fetchDownloadQueue();
+
+    ASSERT_EQ(queue_spy.count(), 1);
+    const auto queue =
+        try_convert<QList<ManagedVideoParts>>(queue_spy.takeFirst()[0]);
+    ASSERT_EQ(queue.size(), 1);
+    EXPECT_EQ(queue.first().id, 2);
+
+    // Dropped along with the video
+    EXPECT_TRUE(query_.exec("UPDATE videos SET removed_at = 0 WHERE id = 1;"));
+    db_.purgeRemovedVideos();
+    EXPECT_TRUE(query_.exec("SELECT COUNT(*) FROM download_queue;") &&
+                query_.next());
+    EXPECT_EQ(query_.value(0).toLongLong(), 1);
+}
+
+TEST_F(DatabaseTest, ExportThenImportHistory) {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QString file_name = dir.filePath("history.jsonl");
+
+    db_.addVideos({info1_, info2_});
+    const auto exported = db_.fetch_first_chunk();
+
+    EXPECT_EQ(db_.export_history(file_name), 2);
+
+    db_.removeAllVideos();
+    EXPECT_EQ(db_.import_history(file_name), 2);
+
+    const auto imported = db_.fetch_first_chunk();
+    ASSERT_EQ(imported.size(), 2);
+    for (qsizetype i = 0; i < imported.size(); ++i) {
+        EXPECT_EQ(imported[i].created_at, exported[i].created_at);
+        EXPECT_EQ(imported[i].info, exported[i].info);
+        EXPECT_THAT(db_.fetch_formats(imported[i].id),
+                    ContainerEq(i == 0 ? info1_.formats() : info2_.formats()));
+    }
+}
+
+TEST_F(DatabaseTest, ImportKeepsDownloadsAndRemovals) {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QString file_name = dir.filePath("history.jsonl");
+
+    db_.addVideos({info1_, info2_});
+    ASSERT_EQ(db_.export_history(file_name), 2);
+
+    db_.saveDownload({.id = 1, .state = DownloadState::kComplete});
+    db_.flushDownloads();
+    db_.removeVideo(2);
+
+    EXPECT_EQ(db_.import_history(file_name), 2);
+
+    const auto chunk = db_.fetch_first_chunk();
+    ASSERT_EQ(chunk.size(), 1);
+    EXPECT_EQ(chunk.first().id, 1);
+    EXPECT_EQ(chunk.first().state, DownloadState::kComplete);
+}
+
+TEST_F(DatabaseTest, ImportSkipsLinesThatArentVideos) {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QString file_name = dir.filePath("history.jsonl");
+
+    db_.addVideo(info1_);
+    ASSERT_EQ(db_.export_history(file_name), 1);
+
+    QFile file(file_name);
+    ASSERT_TRUE(file.open(QIODevice::Append));
+    file.write("not json\n\n{\"title\": \"missing fields\"}\n");
+    file.close();
+
+    db_.removeAllVideos();
+    EXPECT_EQ(db_.import_history(file_name), 1);
+    EXPECT_EQ(rows_in_videos(), 1);
+}
+
+TEST(DatabaseImportTest, MissingFile) {
+    const QString connection_name = QString::fromStdString(test_name());
+    {
+        Database db = Database::get_temp(connection_name);
+        QSignalSpy imported_spy(&db, &Database::historyImported);
+        QSignalSpy error_spy(&db, &Database::errorPushed);
+
+        db.importHistory("missing.jsonl");
+
+        EXPECT_EQ(imported_spy.count(), 0);
+        EXPECT_EQ(error_spy.count(), 1);
+    }
+    QSqlDatabase::removeDatabase(connection_name);
+}
+
+TEST(DatabaseChangesTest, ChangesOfOtherConnectionsReported) {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QString file_name = dir.filePath("history.db");
+
+    const QString connection_name = QString::fromStdString(test_name());
+    const QString other_name = connection_name % "_other";
+    {
+        Database db = Database::get_temp(connection_name, file_name);
+        Database other = Database::get_temp(other_name, file_name);
+        ASSERT_TRUE(db.valid() && other.valid());
+
+        QSignalSpy changed_spy(&db, &Database::historyChanged);
+        QSignalSpy reset_spy(&db, &Database::historyReset);
+        const auto make_info = [](const QString& video_id) {
+            return VideoInfo(video_id, "title", "author", 1, "thumbnail",
+                             "url", {}, true);
+        };
+
+        // Its own changes aren't reported
+        db.addVideo(make_info("own"));
+        db.checkForChanges();
+        EXPECT_EQ(changed_spy.count(), 0);
+
+        other.addVideos({make_info("a"), make_info("b")});
+        db.checkForChanges();
+        ASSERT_EQ(changed_spy.count(), 1);
+        auto args = changed_spy.takeFirst();
+        auto shown = try_convert<QList<ManagedVideoParts>>(args[0]);
+        ASSERT_EQ(shown.size(), 2);
+        EXPECT_EQ(shown[0].info.video_id(), "a");
+        EXPECT_EQ(shown[1].info.video_id(), "b");
+        EXPECT_TRUE(try_convert<QList<qint64>>(args[1]).empty());
+
+        // Nothing changed since
+        db.checkForChanges();
+        EXPECT_EQ(changed_spy.count(), 0);
+
+        other.removeVideo(shown[0].id);
+        db.checkForChanges();
+        ASSERT_EQ(changed_spy.count(), 1);
+        args = changed_spy.takeFirst();
+        EXPECT_TRUE(try_convert<QList<ManagedVideoParts>>(args[0]).empty());
+        EXPECT_THAT(try_convert<QList<qint64>>(args[1]),
+                    ContainerEq(QList<qint64>{shown[0].id}));
+
+        other.removeAllVideos();
+        db.checkForChanges();
+        EXPECT_EQ(changed_spy.count(), 0);
+        EXPECT_EQ(reset_spy.count(), 1);
+        EXPECT_TRUE(db.fetch_first_chunk().empty());
+    }
+    QSqlDatabase::removeDatabase(other_name);
+    QSqlDatabase::removeDatabase(connection_name);
+}
+
+TEST(DatabaseChangesTest, ImportElsewhereReportedAsReset) {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QString file_name = dir.filePath("history.db");
+    const QString export_name = dir.filePath("history.jsonl");
+
+    const QString connection_name = QString::fromStdString(test_name());
+    const QString other_name = connection_name % "_other";
+    {
+        Database db = Database::get_temp(connection_name, file_name);
+        Database other = Database::get_temp(other_name, file_name);
+        ASSERT_TRUE(db.valid() && other.valid());
+
+        QList<VideoInfo> infos;
+        for (qint64 i = 0; i < 3; ++i) {
+            infos << VideoInfo(QString::number(i), "title", "author", 1,
+                               "thumbnail", "url", {}, true);
+        }
+        other.addVideos(infos);
+        ASSERT_EQ(other.export_history(export_name), 3);
+        other.removeAllVideos();
+        db.checkForChanges();
+
+        QSignalSpy changed_spy(&db, &Database::historyChanged);
+        QSignalSpy reset_spy(&db, &Database::historyReset);
+        QSqlQuery query(QSqlDatabase::database(connection_name));
+        const auto changes_logged = [&query] {
+            EXPECT_TRUE(query.exec("SELECT COUNT(*) FROM history_changes;") &&
+                        query.next());
+            return query.value(0).toLongLong();
+        };
+        const qint64 changes_before = changes_logged();
+
+        ASSERT_EQ(other.import_history(export_name), 3);
+        EXPECT_EQ(changes_logged(), changes_before + 1)
+            << "The import should be logged as a single reset";
+
+        db.checkForChanges();
+        EXPECT_EQ(changed_spy.count(), 0);
+        EXPECT_EQ(reset_spy.count(), 1);
+        EXPECT_EQ(db.fetch_first_chunk().size(), 3);
+    }
+    QSqlDatabase::removeDatabase(other_name);
+    QSqlDatabase::removeDatabase(connection_name);
+}
+
+TEST_F(DatabaseTest, OldChangesTrimmed) {
+    db_.addVideos({info1_, info2_});
+    EXPECT_TRUE(query_.exec("UPDATE history_changes SET changed_at = 0;"));
+    db_.addVideo(info1_);
+
+    db_.pruneHistory({});
+
+    EXPECT_TRUE(query_.exec("SELECT videos_id FROM history_changes;"));
+    QList<qint64> ids;
+    while (query_.next()) ids << query_.value(0).toLongLong();
+    EXPECT_THAT(ids, ContainerEq(QList<qint64>{1}));
+}
+
 TEST_F(DatabaseTest, RemoveAllOnTwoVideos) {
     db_.addVideo(info1_);
     db_.addVideo(info2_);
@@ -498,4 +1378,165 @@ TEST_F(DatabaseTest, RemoveAllOnTwoVideos) {
     EXPECT_EQ(rows_in_videos(), 0);
 }
 
+TEST_F(DatabaseTest, RemoveAllOverSeveralBatches) {
+    QList<VideoInfo> infos;
+    for (qint64 i = 0; i < 1201; ++i) {
+        infos << without_video_id(info1_);
+    }
+    db_.addVideos(infos);
+
+    db_.removeAllVideos();
+
+    EXPECT_EQ(rows_in_videos(), 0);
+    EXPECT_TRUE(db_.fetch_first_chunk().empty());
+}
+
+TEST_F(DatabaseTest, VideoAddedAfterClearIsShown) {
+    db_.addVideos({info1_, info2_});
+    db_.removeAllVideos();
+
+    db_.addVideo(info1_);
+
+    const auto chunk = db_.fetch_first_chunk();
+    ASSERT_EQ(chunk.size(), 1);
+    EXPECT_EQ(chunk.first().info.video_id(), info1_.video_id());
+}
+
+TEST_F(DatabaseTest, PruneWithoutRetentionKeepsAll) {
+    db_.addVideos({info1_, info2_});
+    QSignalSpy progress_spy(&db_, &Database::pruneProgress);
+
+    db_.pruneHistory({});
+
+    EXPECT_EQ(rows_in_videos(), 2);
+    ASSERT_EQ(progress_spy.count(), 1);
+    const auto arguments = progress_spy.takeFirst();
+    EXPECT_EQ(try_convert<qint64>(arguments[0]), 0);
+    EXPECT_EQ(try_convert<qint64>(arguments[1]), 0);
+}
+
+TEST_F(DatabaseTest, PruneToMaxVideos) {
+    QList<VideoInfo> infos;
+    for (qint64 i = 0; i < 1201; ++i) {
+        infos << without_video_id(info1_);
+    }
+    db_.addVideos(infos);
+    QSignalSpy progress_spy(&db_, &Database::pruneProgress);
+
+    db_.pruneHistory({.max_videos = 100});
+
+    EXPECT_EQ(rows_in_videos(), 100);
+    EXPECT_EQ(db_.stats().videos, 100);
+    EXPECT_EQ(db_.fetch_first_chunk().last().id, 1201);
+
+    // One per batch
+    ASSERT_EQ(progress_spy.count(), 3);
+    const auto first = progress_spy.first();
+    EXPECT_EQ(try_convert<qint64>(first[0]), 500);
+    EXPECT_EQ(try_convert<qint64>(first[1]), 1101);
+    const auto last = progress_spy.last();
+    EXPECT_EQ(try_convert<qint64>(last[0]), 1101);
+    EXPECT_EQ(try_convert<qint64>(last[1]), 1101);
+}
+
+TEST_F(DatabaseTest, PruneByAge) {
+    db_.addVideos({info1_, info2_});
+    EXPECT_TRUE(query_.exec("UPDATE videos SET created_at = 0 WHERE id = 1;"));
+
+    db_.pruneHistory({.max_age_days = 1});
+
+    EXPECT_TRUE(query_.exec("SELECT id FROM videos;") && query_.next());
+    EXPECT_EQ(query_.value(0).toLongLong(), 2);
+    EXPECT_FALSE(query_.next());
+}
+
+TEST_F(DatabaseTest, PruneDownloadedWhenKeepingOnlyIncomplete) {
+    db_.addVideos({info1_, info2_});
+    db_.saveDownload({.id = 1, .state = DownloadState::kComplete});
+    db_.saveDownload({.id = 2, .state = DownloadState::kDownloading});
+    db_.flushDownloads();
+
+    db_.pruneHistory({.keep_only_incomplete = true});
+
+    EXPECT_TRUE(query_.exec("SELECT id FROM videos;") && query_.next());
+    EXPECT_EQ(query_.value(0).toLongLong(), 2);
+    EXPECT_FALSE(query_.next());
+}
+
+TEST_F(DatabaseTest, DownloadedAtKeptUntilDownloadedAgain) {
+    db_.addVideo(info1_);
+    const auto downloaded_at = [this] {
+        EXPECT_TRUE(query_.exec("SELECT downloaded_at FROM videos;") &&
+                    query_.next());
+        return query_.value(0);
+    };
+
+    db_.saveDownload({.id = 1, .state = DownloadState::kComplete});
+    db_.flushDownloads();
+    EXPECT_FALSE(downloaded_at().isNull());
+
+    // e.g., its format changed after it completed
+    EXPECT_TRUE(query_.exec("UPDATE videos SET downloaded_at = 1;"));
+    db_.saveDownload({.id = 1,
+                      .state = DownloadState::kComplete,
+                      .selected_format = "format"});
+    db_.flushDownloads();
+    EXPECT_EQ(downloaded_at().toLongLong(), 1);
+
+    db_.saveDownload({.id = 1, .state = DownloadState::kQueued});
+    db_.flushDownloads();
+    EXPECT_TRUE(downloaded_at().isNull());
+}
+
+TEST_F(DatabaseTest, PruneKeepsQueuedDownloads) {
+    db_.addVideos({info1_, info2_});
+    EXPECT_TRUE(query_.exec("UPDATE videos SET created_at = 0;"));
+    db_.enqueueDownload(1);
+    QSignalSpy pruned_spy(&db_, &Database::videosPruned);
+
+    db_.pruneHistory({.max_age_days = 1});
+
+    ASSERT_EQ(pruned_spy.count(), 1);
+    EXPECT_THAT(try_convert<QList<qint64>>(pruned_spy.first()[0]),
+                testing::ElementsAre(2));
+    EXPECT_EQ(rows_in_videos(), 1);
+}
+
+TEST(DatabaseClearTest, InterruptedClearResumedOnOpen) {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QString file_name = dir.filePath("history.db");
+
+    const QString connection_name = QString::fromStdString(test_name());
+    {
+        Database db = Database::get_temp(connection_name, file_name);
+        ASSERT_TRUE(db.valid());
+        for (qint64 i = 0; i < 3; ++i) {
+            db.addVideo(VideoInfo("", "title", "author", 1, "thumbnail", "url",
+                                  {}, true));
+        }
+
+        // As if quit after hiding the first two but before removing them
+        ASSERT_TRUE(QSqlQuery(QSqlDatabase::database(connection_name))
+                        .exec("UPDATE history_meta SET cleared_up_to = 2;"));
+    }
+    QSqlDatabase::removeDatabase(connection_name);
+
+    {
+        Database db = Database::get_temp(connection_name, file_name);
+        ASSERT_TRUE(db.valid());
+
+        QSqlQuery query(QSqlDatabase::database(connection_name));
+        ASSERT_TRUE(query.exec("SELECT id FROM videos;"));
+        QList<qint64> ids;
+        while (query.next()) ids << query.value(0).toLongLong();
+        EXPECT_THAT(ids, ContainerEq(QList<qint64>{3}));
+
+        const auto chunk = db.fetch_first_chunk();
+        ASSERT_EQ(chunk.size(), 1);
+        EXPECT_EQ(chunk.first().id, 3);
+    }
+    QSqlDatabase::removeDatabase(connection_name);
+}
+
 }  // namespace yd_gui
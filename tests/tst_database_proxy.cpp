@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+#include <qlist.h>
+#include <qsignalspy.h>
+#include <qstring.h>
+
+#include "_tst_util.h"
+#include "database.h"
+#include "database_proxy.h"
+#include "gmock/gmock.h"
+#include "video.h"
+
+using namespace tst_util;  // NOLINT(google-build-using-namespace)
+
+namespace yd_gui {
+
+class DatabaseProxyTest : public testing::Test {
+   protected:
+    explicit DatabaseProxyTest() { EXPECT_TRUE(db_.valid()); }
+
+    Database db_{Database::get_temp(QString::fromStdString(test_name()))};
+
+    DatabaseProxy proxy_{db_};
+};
+
+TEST_F(DatabaseProxyTest, MirrorsValid) {
+    QSignalSpy valid_spy(&proxy_, &DatabaseProxy::validChanged);
+    EXPECT_TRUE(proxy_.valid());
+
+    db_.setValid(false);
+
+    EXPECT_EQ(valid_spy.count(), 1);
+    EXPECT_FALSE(proxy_.valid());
+}
+
+TEST_F(DatabaseProxyTest, ForwardsErrors) {
+    QSignalSpy error_spy(&proxy_, &DatabaseProxy::errorPushed);
+
+    emit db_.errorPushed("error");
+
+    ASSERT_EQ(error_spy.count(), 1);
+    EXPECT_EQ(try_convert<QString>(error_spy.takeFirst().takeFirst()),
+              "error");
+}
+
+TEST_F(DatabaseProxyTest, AddVideoBatched) {
+    QSignalSpy video_spy(&db_, &Database::videosPushed);
+
+    proxy_.addVideoBatched(VideoInfo("video_id", "title", "author", 1,
+                                     "thumbnail", "url", {}, true));
+
+    ASSERT_TRUE(wait_for_n_signals(video_spy, 1));
+    const auto parts = try_convert<QList<ManagedVideoParts>>(
+        video_spy.takeFirst().takeFirst());
+    ASSERT_EQ(parts.size(), 1);
+    EXPECT_EQ(parts.first().info.video_id(), "video_id");
+}
+
+}  // namespace yd_gui
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include <qabstractitemmodel.h>
+#include <qlist.h>
+#include <qsignalspy.h>
+#include <qtypes.h>
+#include <qvariant.h>
+
+#include "_tst_util.h"
+#include "gmock/gmock.h"
+#include "history_stats_model.h"
+#include "video.h"
+
+using namespace tst_util;  // NOLINT(google-build-using-namespace)
+
+namespace yd_gui {
+
+using HistoryStatsModelRole = HistoryStatsModel::HistoryStatsModelRole;
+
+class HistoryStatsModelTest : public testing::Test {
+   protected:
+    explicit HistoryStatsModelTest() { EXPECT_TRUE(db_.valid()); }
+
+    // Each has its own video_id so none are deduplicated
+    static VideoInfo make_info(const QString& author, const quint32 seconds) {
+        static qint64 count = 0;
+        return VideoInfo(QString::number(count++), "title", author, seconds,
+                         "thumbnail", "url", {}, true);
+    }
+
+    QString key_at(const int row) {
+        return try_convert<QString>(
+            model_.data(model_.index(row),
+                        static_cast<int>(HistoryStatsModelRole::kKeyRole)));
+    }
+
+    qint64 videos_at(const int row) {
+        return try_convert<qint64>(
+            model_.data(model_.index(row),
+                        static_cast<int>(HistoryStatsModelRole::kVideosRole)));
+    }
+
+    Database db_{Database::get_temp(QString::fromStdString(test_name()))};
+
+    HistoryStatsModel model_{db_};
+};
+
+TEST_F(HistoryStatsModelTest, EmptyHistory) {
+    EXPECT_EQ(model_.videos(), 0);
+    EXPECT_EQ(model_.seconds(), 0);
+    EXPECT_EQ(model_.rowCount(), 0);
+}
+
+TEST_F(HistoryStatsModelTest, RefreshedWhenVideosAdded) {
+    QSignalSpy totals_spy(&model_, &HistoryStatsModel::totalsChanged);
+
+    db_.addVideos({make_info("a", 10), make_info("b", 20)});
+
+    EXPECT_EQ(totals_spy.count(), 1);
+    EXPECT_EQ(model_.videos(), 2);
+    EXPECT_EQ(model_.seconds(), 30);
+
+    // All added this month
+    ASSERT_EQ(model_.rowCount(), 1);
+    EXPECT_EQ(videos_at(0), 2);
+}
+
+TEST_F(HistoryStatsModelTest, GroupByAuthor) {
+    db_.addVideos({make_info("a", 1), make_info("b", 1), make_info("b", 1)});
+
+    QSignalSpy reset_spy(&model_, &HistoryStatsModel::modelReset);
+    model_.setGroupBy(HistoryStatsModel::GroupBy::kAuthor);
+
+    EXPECT_EQ(reset_spy.count(), 1);
+    ASSERT_EQ(model_.rowCount(), 2);
+    EXPECT_EQ(key_at(0), "b");
+    EXPECT_EQ(videos_at(0), 2);
+    EXPECT_EQ(key_at(1), "a");
+    EXPECT_EQ(videos_at(1), 1);
+}
+
+TEST_F(HistoryStatsModelTest, RefreshAfterRemoval) {
+    db_.addVideos({make_info("a", 1), make_info("b", 1)});
+
+    db_.removeVideo(1);
+    model_.refresh();
+    EXPECT_EQ(model_.videos(), 1);
+}
+
+TEST_F(HistoryStatsModelTest, RefreshedWhenVideosRemoved) {
+    db_.addVideos({make_info("a", 1), make_info("b", 1), make_info("c", 1)});
+
+    db_.removeVideo(1);
+    EXPECT_EQ(model_.videos(), 2);
+
+    db_.removeAllVideos();
+    EXPECT_EQ(model_.videos(), 0);
+    EXPECT_EQ(model_.rowCount(), 0);
+}
+
+TEST_F(HistoryStatsModelTest, RefreshedWhenHistoryChangedElsewhere) {
+    QSignalSpy stats_spy(&db_, &Database::statsFetched);
+
+    emit db_.historyChanged({}, {});
+    emit db_.historyReset();
+
+    EXPECT_EQ(stats_spy.count(), 2);
+}
+
+}  // namespace yd_gui
@@ -0,0 +1,38 @@
+#include <gtest/gtest.h>
+#include <qbytearray.h>
+#include <qlist.h>
+
+#include "_tst_util.h"  // IWYU pragma: keep
+#include "gmock/gmock.h"
+#include "video.h"
+
+using namespace tst_util;  // NOLINT(google-build-using-namespace)
+
+namespace yd_gui {
+
+class VideoInfoTest : public testing::Test {
+   protected:
+    QList<VideoFormat> formats_{
+        VideoFormat{"format1", "mp4", 100, 200, 30},
+        VideoFormat{"format2", "webm", 300, 400, 29.97F}};
+
+    VideoInfo info_{"info",      "title", "author", 1,
+                    "thumbnail", "url",   formats_, true};
+};
+
+TEST_F(VideoInfoTest, PackFormatsRoundTrip) {
+    const QByteArray packed = VideoInfo::pack_formats(formats_);
+
+    EXPECT_THAT(VideoInfo::unpack_formats(packed), ContainerEq(formats_));
+}
+
+TEST_F(VideoInfoTest, PackNoFormatsIsEmpty) {
+    EXPECT_TRUE(VideoInfo::pack_formats({}).isEmpty());
+    EXPECT_TRUE(VideoInfo::unpack_formats({}).empty());
+}
+
+TEST_F(VideoInfoTest, UnpackMalformedFormats) {
+    EXPECT_TRUE(VideoInfo::unpack_formats("not cbor").empty());
+}
+
+}  // namespace yd_gui
@@ -2,6 +2,9 @@
 #include <qabstractitemmodel.h>
 #include <qlist.h>
 #include <qsignalspy.h>
+#include <qsqldatabase.h>
+#include <qsqlquery.h>
+#include <qtemporarydir.h>
 #include <qtypes.h>
 #include <qvariant.h>
 
@@ -22,6 +25,12 @@ class VideoListModelTest : public testing::Test {
    protected:
     explicit VideoListModelTest() { EXPECT_TRUE(db_.valid()); }
 
+    static constexpr int kIdRole =
+        static_cast<int>(VideoListModelRole::kIdRole);
+
+    static constexpr int kFormatsLoadedRole =
+        static_cast<int>(VideoListModelRole::kFormatsLoaded);
+
     static constexpr int kCreatedAtRole =
         static_cast<int>(VideoListModelRole::kCreatedAtRole);
 
@@ -41,11 +50,11 @@ class VideoListModelTest : public testing::Test {
                                      .created_at = 4,
                                      .info = VideoInfo(),
                                      .state = DownloadState::kAdded},
-                                    {.id = 4,
+                                    {.id = 5,
                                      .created_at = 4,
                                      .info = VideoInfo(),
                                      .state = DownloadState::kAdded},
-                                    {.id = 4,
+                                    {.id = 6,
                                      .created_at = 4,
                                      .info = VideoInfo(),
                                      .state = DownloadState::kAdded}};
@@ -61,19 +70,33 @@ class VideoListModelTest : public testing::Test {
                                          .created_at = 3,
                                          .info = VideoInfo(),
                                          .state = DownloadState::kAdded}};
-    QList<ManagedVideoParts> parts_desc_{{.id = 3,
+    // Distinct ids from parts_asc_ so both can be in a model at once
+    QList<ManagedVideoParts> parts_desc_{{.id = 9,
                                           .created_at = 3,
                                           .info = VideoInfo(),
                                           .state = DownloadState::kAdded},
-                                         {.id = 2,
+                                         {.id = 8,
                                           .created_at = 2,
                                           .info = VideoInfo(),
                                           .state = DownloadState::kAdded},
-                                         {.id = 1,
+                                         {.id = 7,
                                           .created_at = 1,
                                           .info = VideoInfo(),
                                           .state = DownloadState::kAdded}};
 
+    // Distinct video_ids so none are deduplicated
+    static VideoInfo make_info(const qint64 index) {
+        return VideoInfo(QString::number(index), "title", "author", 1,
+                         "thumbnail", "url", {}, true);
+    }
+
+    VideoInfo info_{"id", "title", "author", 1, "thumbnail", "url", {}, true};
+
+    VideoFormat format_{"format", "mp4", 100, 200, 30};
+
+    VideoInfo info_with_formats_{"formats id", "title", "author", 1,
+                                 "thumbnail",  "url",   {format_}, true};
+
     Database db_{Database::get_temp(QString::fromStdString(test_name()))};
 
     VideoListModel model_{db_};
@@ -110,6 +133,28 @@ TEST_F(VideoListModelTest, PrependVideos) {
     }
 }
 
+TEST_F(VideoListModelTest, PrependVideosInsertsOneBlock) {
+    model_.appendVideos(parts_asc_);
+    QSignalSpy insert_spy(&model_, &VideoListModel::rowsInserted);
+
+    model_.prependVideos(parts_);
+
+    ASSERT_EQ(insert_spy.count(), 1);
+    EXPECT_EQ(try_convert<int>(insert_spy[0][1]), 0);
+    EXPECT_EQ(try_convert<int>(insert_spy[0][2]), parts_.size() - 1);
+    EXPECT_EQ(try_convert<qint64>(model_.data(model_.index(0), kIdRole)), 4);
+    EXPECT_EQ(try_convert<qint64>(model_.data(model_.index(2), kIdRole)), 6);
+}
+
+TEST_F(VideoListModelTest, PrependVideosSkipsLoadedIds) {
+    model_.appendVideos(parts_asc_);
+
+    // e.g., a page read right after they were added
+    model_.prependVideos(parts_ + parts_asc_);
+
+    EXPECT_EQ(model_.rowCount(), parts_.size() + parts_asc_.size());
+}
+
 TEST_F(VideoListModelTest, AppendThenPrependVideos) {
     EXPECT_EQ(model_.rowCount(), 0);
 
@@ -142,6 +187,350 @@ TEST_F(VideoListModelTest, PrependThenAppendVideos) {
     }
 }
 
+TEST_F(VideoListModelTest, PushedVideosAreAppended) {
+    db_.addVideo(info_);
+    db_.addVideo(VideoInfo("other id", "title", "author", 1, "thumbnail",
+                           "url", {}, true));
+
+    EXPECT_EQ(model_.rowCount(), 2);
+}
+
+TEST_F(VideoListModelTest, AppendVideosReplacesSameId) {
+    model_.appendVideos(parts_asc_);
+
+    model_.appendVideos({{.id = 1,
+                          .created_at = 5,
+                          .info = VideoInfo(),
+                          .state = DownloadState::kAdded},
+                         {.id = 1,
+                          .created_at = 6,
+                          .info = VideoInfo(),
+                          .state = DownloadState::kAdded}});
+
+    ASSERT_EQ(model_.rowCount(), 3);
+    EXPECT_EQ(try_convert<qint64>(model_.data(model_.index(2), kIdRole)), 1);
+    EXPECT_EQ(try_convert<qint64>(model_.data(model_.index(2), kCreatedAtRole)),
+              6);
+}
+
+TEST_F(VideoListModelTest, AppendVideosKeepsActiveSameId) {
+    model_.appendVideos(parts_asc_);
+    model_.setData(model_.index(0), QVariant::fromValue(DownloadState::kQueued),
+                   static_cast<int>(VideoListModelRole::kState));
+
+    model_.appendVideos({{.id = 1,
+                          .created_at = 5,
+                          .info = VideoInfo(),
+                          .state = DownloadState::kAdded}});
+
+    ASSERT_EQ(model_.rowCount(), 3);
+    EXPECT_EQ(try_convert<qint64>(model_.data(model_.index(0), kCreatedAtRole)),
+              1);
+}
+
+TEST_F(VideoListModelTest, PaginateOnConstruction) {
+    db_.addVideo(info_);
+    db_.addVideo(VideoInfo("other id", "title", "author", 1, "thumbnail",
+                           "url", {}, true));
+
+    VideoListModel model(db_);
+
+    EXPECT_EQ(model.rowCount(), 2);
+}
+
+TEST_F(VideoListModelTest, PrefetchReadsAheadWithoutShowing) {
+    QList<VideoInfo> infos;
+    for (qint64 i = 0; i < 3 * Database::kChunkSize; ++i) {
+        infos << make_info(i);
+    }
+    db_.addVideos(infos);
+
+    VideoListModel model(db_);
+    ASSERT_EQ(model.rowCount(), Database::kChunkSize);
+
+    QSignalSpy chunk_spy(&db_, &Database::chunkFetched);
+    model.prefetch();
+
+    EXPECT_EQ(model.rowCount(), Database::kChunkSize);
+    EXPECT_EQ(chunk_spy.count(), VideoListModel::kReadAheadPages);
+
+    // Handed over from what was read ahead
+    model.paginate();
+    EXPECT_EQ(model.rowCount(), 2 * Database::kChunkSize);
+
+    model.paginate();
+    EXPECT_EQ(model.rowCount(), 3 * Database::kChunkSize);
+}
+
+TEST_F(VideoListModelTest, AddedVideoReplacesReadAheadCopy) {
+    QList<VideoInfo> infos;
+    for (qint64 i = 0; i < 2 * Database::kChunkSize; ++i) {
+        infos << make_info(i);
+    }
+    db_.addVideos(infos);
+
+    VideoListModel model(db_);
+    model.prefetch();
+
+    // Upserts the oldest video, which was read ahead
+    db_.addVideo(make_info(0));
+    EXPECT_EQ(model.rowCount(), Database::kChunkSize + 1);
+
+    model.paginate();
+    EXPECT_EQ(model.rowCount(), 2 * Database::kChunkSize);
+}
+
+TEST_F(VideoListModelTest, SeekToTimeThenPageBothWays) {
+    QList<VideoInfo> infos;
+    for (qint64 i = 0; i < 3 * Database::kChunkSize; ++i) {
+        infos << make_info(i);
+    }
+    db_.addVideos(infos);
+    QSqlQuery query(
+        QSqlDatabase::database(QString::fromStdString(test_name())));
+    ASSERT_TRUE(query.exec("UPDATE videos SET created_at = id;"));
+
+    VideoListModel model(db_);
+    ASSERT_EQ(model.rowCount(), Database::kChunkSize);
+
+    // A page from either side of it, ids matching created_at
+    const qint64 seek_to = Database::kChunkSize + Database::kChunkSize / 2;
+    model.seekTo(seek_to);
+    ASSERT_EQ(model.rowCount(), 2 * Database::kChunkSize);
+    EXPECT_EQ(try_convert<qint64>(model.data(model.index(0), kIdRole)),
+              seek_to - Database::kChunkSize + 1);
+    EXPECT_EQ(try_convert<qint64>(model.data(
+                  model.index(model.rowCount() - 1), kIdRole)),
+              seek_to + Database::kChunkSize);
+
+    model.paginateNewer();
+    model.paginate();
+    EXPECT_EQ(model.rowCount(), 3 * Database::kChunkSize);
+
+    // Both ends were reached
+    model.paginateNewer();
+    model.paginate();
+    EXPECT_EQ(model.rowCount(), 3 * Database::kChunkSize);
+}
+
+TEST_F(VideoListModelTest, FinishedDownloadKeptBySeekIsPagedAgain) {
+    QList<VideoInfo> infos;
+    for (qint64 i = 0; i < 3 * Database::kChunkSize; ++i) {
+        infos << make_info(i);
+    }
+    db_.addVideos(infos);
+    QSqlQuery query(
+        QSqlDatabase::database(QString::fromStdString(test_name())));
+    ASSERT_TRUE(query.exec("UPDATE videos SET created_at = id;"));
+
+    VideoListModel model(db_);
+    const auto row_of = [&model](const qint64 id) {
+        for (int row = 0; row < model.rowCount(); ++row) {
+            if (try_convert<qint64>(model.data(model.index(row), kIdRole)) ==
+                id)
+                return row;
+        }
+        return -1;
+    };
+    const qint64 newest = 3 * Database::kChunkSize;
+    const auto state_role = static_cast<int>(VideoListModelRole::kState);
+
+    // Kept ahead of its page while downloading
+    model.setData(model.index(row_of(newest)),
+                  QVariant::fromValue(DownloadState::kQueued), state_role);
+    model.seekTo(Database::kChunkSize);
+    ASSERT_NE(row_of(newest), -1);
+
+    // Unloaded once done, then shown with its page
+    model.setData(model.index(row_of(newest)),
+                  QVariant::fromValue(DownloadState::kComplete), state_role);
+    model.seekTo(newest);
+    EXPECT_NE(row_of(newest), -1);
+}
+
+TEST_F(VideoListModelTest, RowsPastWindowAreUnloaded) {
+    constexpr qint64 kVideos =
+        VideoListModel::kWindowRows + 2 * Database::kChunkSize;
+    QList<VideoInfo> infos;
+    for (qint64 i = 0; i < kVideos; ++i) {
+        infos << make_info(i);
+    }
+    db_.addVideos(infos);
+    QSqlQuery query(
+        QSqlDatabase::database(QString::fromStdString(test_name())));
+    ASSERT_TRUE(query.exec("UPDATE videos SET created_at = id;"));
+
+    VideoListModel model(db_);
+    const auto id_at = [&model](const int row) {
+        return try_convert<qint64>(model.data(model.index(row), kIdRole));
+    };
+
+    // Down to the oldest video, the newest are unloaded
+    for (qint64 page = 1; page * Database::kChunkSize < kVideos; ++page) {
+        model.paginate();
+    }
+    ASSERT_EQ(model.rowCount(), VideoListModel::kWindowRows);
+    EXPECT_EQ(id_at(0), 1);
+    EXPECT_EQ(id_at(model.rowCount() - 1), VideoListModel::kWindowRows);
+
+    // Then back up, the oldest are unloaded
+    model.paginateNewer();
+    ASSERT_EQ(model.rowCount(), VideoListModel::kWindowRows);
+    EXPECT_EQ(id_at(0), Database::kChunkSize + 1);
+    EXPECT_EQ(id_at(model.rowCount() - 1),
+              VideoListModel::kWindowRows + Database::kChunkSize);
+
+    model.paginate();
+    EXPECT_EQ(id_at(0), 1);
+}
+
+TEST_F(VideoListModelTest, AddedVideoWaitsForNewerPages) {
+    QList<VideoInfo> infos;
+    for (qint64 i = 0; i < 3 * Database::kChunkSize; ++i) {
+        infos << make_info(i);
+    }
+    db_.addVideos(infos);
+    QSqlQuery query(
+        QSqlDatabase::database(QString::fromStdString(test_name())));
+    ASSERT_TRUE(query.exec("UPDATE videos SET created_at = id;"));
+
+    VideoListModel model(db_);
+    const auto row_of = [&model](const qint64 id) {
+        for (int row = 0; row < model.rowCount(); ++row) {
+            if (try_convert<qint64>(model.data(model.index(row), kIdRole)) ==
+                id)
+                return row;
+        }
+        return -1;
+    };
+    model.seekTo(Database::kChunkSize + Database::kChunkSize / 2);
+    ASSERT_EQ(model.rowCount(), 2 * Database::kChunkSize);
+
+    // Newer than the unloaded rows, so it comes after them
+    db_.addVideo(make_info(3 * Database::kChunkSize));
+    const qint64 added = 3 * Database::kChunkSize + 1;
+    EXPECT_EQ(model.rowCount(), 2 * Database::kChunkSize);
+    EXPECT_EQ(row_of(added), -1);
+
+    model.paginateNewer();
+    EXPECT_NE(row_of(3 * Database::kChunkSize), -1);
+    EXPECT_EQ(row_of(added), model.rowCount() - 1);
+}
+
+TEST_F(VideoListModelTest, RestoredVideoIsNotUnloadedAsNewest) {
+    constexpr qint64 kVideos =
+        VideoListModel::kWindowRows + 2 * Database::kChunkSize;
+    QList<VideoInfo> infos;
+    for (qint64 i = 0; i < kVideos; ++i) {
+        infos << make_info(i);
+    }
+    db_.addVideos(infos);
+    QSqlQuery query(
+        QSqlDatabase::database(QString::fromStdString(test_name())));
+    ASSERT_TRUE(query.exec("UPDATE videos SET created_at = id;"));
+
+    VideoListModel model(db_);
+    const auto row_of = [&model](const qint64 id) {
+        for (int row = 0; row < model.rowCount(); ++row) {
+            if (try_convert<qint64>(model.data(model.index(row), kIdRole)) ==
+                id)
+                return row;
+        }
+        return -1;
+    };
+    while (model.rowCount() < VideoListModel::kWindowRows) {
+        model.paginate();
+    }
+    const qint64 oldest = 2 * Database::kChunkSize + 1;
+    ASSERT_EQ(row_of(oldest), 0);
+
+    // Restored after the newest row, though older than all others
+    model.removeVideo(0);
+    model.undoRemoveVideo();
+    ASSERT_EQ(row_of(oldest), model.rowCount() - 1);
+
+    // The newest page is unloaded rather than the restored video
+    model.paginate();
+    ASSERT_EQ(model.rowCount(), VideoListModel::kWindowRows);
+    EXPECT_NE(row_of(oldest), -1);
+    EXPECT_EQ(row_of(kVideos), -1);
+
+    // And paged again from where it was unloaded
+    model.paginateNewer();
+    EXPECT_NE(row_of(kVideos - Database::kChunkSize + 1), -1);
+    EXPECT_NE(row_of(kVideos), -1);
+}
+
+TEST_F(VideoListModelTest, PageSizeFollowsVisibleRows) {
+    VideoListModel model(db_);
+    EXPECT_EQ(model.page_size(), Database::kChunkSize);
+
+    model.setVisibleRows(20);
+    EXPECT_EQ(model.page_size(), 20 * VideoListModel::kScreensPerPage);
+
+    model.setVisibleRows(1);
+    EXPECT_EQ(model.page_size(), VideoListModel::kMinPageSize);
+
+    model.setVisibleRows(1000);
+    EXPECT_EQ(model.page_size(), VideoListModel::kMaxPageSize);
+
+    // Unknown again
+    model.setVisibleRows(0);
+    EXPECT_EQ(model.page_size(), Database::kChunkSize);
+}
+
+TEST_F(VideoListModelTest, PaginateFetchesPageSize) {
+    QList<VideoInfo> infos;
+    for (qint64 i = 0; i < 4 * Database::kChunkSize; ++i) {
+        infos << make_info(i);
+    }
+    db_.addVideos(infos);
+
+    VideoListModel model(db_);
+    ASSERT_EQ(model.rowCount(), Database::kChunkSize);
+
+    model.setVisibleRows(30);
+    model.paginate();
+    EXPECT_EQ(model.rowCount(), Database::kChunkSize + model.page_size());
+}
+
+TEST_F(VideoListModelTest, LoadFormatsOfHistoryVideo) {
+    db_.addVideo(info_with_formats_);
+
+    VideoListModel model(db_);
+    ASSERT_EQ(model.rowCount(), 1);
+    EXPECT_FALSE(
+        try_convert<bool>(model.data(model.index(0), kFormatsLoadedRole)));
+
+    model.loadFormats(0);
+
+    EXPECT_TRUE(
+        try_convert<bool>(model.data(model.index(0), kFormatsLoadedRole)));
+    const auto info = try_convert<VideoInfo>(model.data(
+        model.index(0), static_cast<int>(VideoListModelRole::kInfoRole)));
+    EXPECT_THAT(info.formats(), ContainerEq(QList<VideoFormat>{format_}));
+    EXPECT_EQ(try_convert<QString>(model.data(
+                  model.index(0),
+                  static_cast<int>(VideoListModelRole::kSelectedFormatRole))),
+              format_.format_id());
+}
+
+TEST_F(VideoListModelTest, DownloadHistoryVideoWaitsForFormats) {
+    db_.addVideo(info_with_formats_);
+
+    VideoListModel model(db_);
+    QSignalSpy request_download_spy(&model,
+                                    &VideoListModel::requestDownloadVideo);
+
+    model.downloadVideo(0);
+
+    // Formats arrive synchronously, db_ lives on this thread
+    ASSERT_EQ(request_download_spy.count(), 1);
+    const auto* const video = try_convert<ManagedVideo*>(
+        request_download_spy.takeFirst().takeFirst());
+    EXPECT_EQ(video->selected_format(), format_.format_id());
+}
+
 TEST_F(VideoListModelTest, RemoveVideo) {
     model_.appendVideos(parts_);
 
@@ -152,6 +541,25 @@ TEST_F(VideoListModelTest, RemoveVideo) {
     EXPECT_EQ(model_.rowCount(), parts_.size() - 1);
 }
 
+TEST_F(VideoListModelTest, UndoRemoveVideo) {
+    db_.addVideos({make_info(0), make_info(1)});
+    ASSERT_EQ(model_.rowCount(), 2);
+    const auto removed_id =
+        try_convert<qint64>(model_.data(model_.index(0), kIdRole));
+
+    model_.removeVideo(0);
+    ASSERT_EQ(model_.rowCount(), 1);
+
+    model_.undoRemoveVideo();
+    ASSERT_EQ(model_.rowCount(), 2);
+    EXPECT_EQ(try_convert<qint64>(model_.data(model_.index(1), kIdRole)),
+              removed_id);
+
+    // Nothing left to undo
+    model_.undoRemoveVideo();
+    EXPECT_EQ(model_.rowCount(), 2);
+}
+
 TEST_F(VideoListModelTest, RemoveVideoLessThanBounds) {
     model_.appendVideos(parts_);
 
@@ -200,6 +608,107 @@ TEST_F(VideoListModelTest, DownloadVideo) {
     EXPECT_EQ(request_download_spy_.count(), 1);
 }
 
+TEST_F(VideoListModelTest, VideoMadeOnceRowIsDownloaded) {
+    model_.appendVideos(parts_);
+    EXPECT_TRUE(model_.findChildren<ManagedVideo*>().empty());
+
+    model_.downloadVideo(1);
+    ASSERT_EQ(request_download_spy_.count(), 1);
+    auto* const video =
+        try_convert<ManagedVideo*>(request_download_spy_.takeFirst()[0]);
+    EXPECT_THAT(model_.findChildren<ManagedVideo*>(),
+                testing::ElementsAre(video));
+    EXPECT_EQ(model_.find_video(*video).row(), 1);
+
+    // Already has one
+    model_.downloadVideo(1);
+    EXPECT_EQ(model_.findChildren<ManagedVideo*>().size(), 1);
+}
+
+TEST_F(VideoListModelTest, FindVideoAfterRowsMove) {
+    model_.appendVideos(parts_asc_);
+    model_.downloadVideo(1);
+    ASSERT_EQ(request_download_spy_.count(), 1);
+    auto* const video =
+        try_convert<ManagedVideo*>(request_download_spy_.takeFirst()[0]);
+    ASSERT_EQ(video->id(), 2);
+
+    model_.prependVideos(parts_);
+    EXPECT_EQ(model_.find_video(*video).row(), 4);
+
+    // From either side of it
+    model_.removeVideo(0);
+    EXPECT_EQ(model_.find_video(*video).row(), 3);
+    model_.removeVideo(4);
+    EXPECT_EQ(model_.find_video(*video).row(), 3);
+
+    video->setProgress(0.5);
+    model_.flushUpdates();
+    ASSERT_EQ(data_spy_.count(), 1);
+    EXPECT_EQ(try_convert<QModelIndex>(data_spy_[0][0]).row(), 3);
+
+    model_.removeVideo(3);
+    EXPECT_FALSE(model_.find_video(*video).isValid());
+}
+
+TEST(VideoRowsTest, RowOfFollowsInsertsAndRemovals) {
+    const auto make_parts = [](const qint64 id) {
+        return ManagedVideoParts{.id = id,
+                                 .created_at = id,
+                                 .info = VideoInfo(),
+                                 .state = DownloadState::kAdded};
+    };
+    const auto rows_of = [](const VideoRows& rows) {
+        QList<qsizetype> result;
+        for (qint64 id = 1; id <= 5; ++id) result << rows.row_of(id);
+        return result;
+    };
+
+    VideoRows rows;
+    rows.append({make_parts(3), make_parts(4)});
+    rows.prepend({make_parts(1), make_parts(2)});
+    rows.append({make_parts(5)});
+    EXPECT_THAT(rows_of(rows), ContainerEq(QList<qsizetype>{0, 1, 2, 3, 4}));
+
+    // Closer to the front, then closer to the back
+    rows.remove(1, 1);
+    EXPECT_THAT(rows_of(rows), ContainerEq(QList<qsizetype>{0, -1, 1, 2, 3}));
+    rows.remove(2, 1);
+    EXPECT_THAT(rows_of(rows), ContainerEq(QList<qsizetype>{0, -1, 1, -1, 2}));
+
+    rows.clear();
+    EXPECT_THAT(rows_of(rows),
+                ContainerEq(QList<qsizetype>{-1, -1, -1, -1, -1}));
+}
+
+TEST_F(VideoListModelTest, UpdatesMergedUntilFlushed) {
+    model_.appendVideos(parts_asc_);
+    model_.downloadAllVideos();
+    ASSERT_EQ(request_download_spy_.count(), 3);
+    auto* const first = try_convert<ManagedVideo*>(request_download_spy_[0][0]);
+    auto* const second =
+        try_convert<ManagedVideo*>(request_download_spy_[1][0]);
+
+    first->setProgress(0.1);
+    first->setProgress(0.2);
+    second->setSelectedFormat("format");
+    EXPECT_EQ(data_spy_.count(), 0);
+
+    model_.flushUpdates();
+    ASSERT_EQ(data_spy_.count(), 1);
+    EXPECT_EQ(try_convert<QModelIndex>(data_spy_[0][0]).row(), 0);
+    EXPECT_EQ(try_convert<QModelIndex>(data_spy_[0][1]).row(), 1);
+    EXPECT_THAT(
+        try_convert<QList<int>>(data_spy_[0][2]),
+        testing::UnorderedElementsAre(
+            static_cast<int>(VideoListModelRole::kProgressRole),
+            static_cast<int>(VideoListModelRole::kSelectedFormatRole)));
+
+    // Nothing left
+    model_.flushUpdates();
+    EXPECT_EQ(data_spy_.count(), 1);
+}
+
 TEST_F(VideoListModelTest, DownloadVideoLessThanBounds) {
     model_.appendVideos(parts_);
 
@@ -316,6 +825,131 @@ TEST_F(VideoListModelTest, SetDataState) {
     }
 }
 
+TEST_F(VideoListModelTest, DownloadSavedToHistory) {
+    db_.addVideo(info_);
+    ASSERT_EQ(model_.rowCount(), 1);
+
+    EXPECT_TRUE(
+        model_.setData(model_.index(0), 0.5,
+                       static_cast<int>(VideoListModelRole::kProgressRole)));
+    db_.flushDownloads();
+
+    const auto chunk = db_.fetch_first_chunk();
+    ASSERT_EQ(chunk.size(), 1);
+    EXPECT_EQ(chunk.first().progress, 0.5);
+}
+
+TEST_F(VideoListModelTest, QueuedVideoIsKeptInDownloadQueue) {
+    db_.addVideo(info_);
+    ASSERT_EQ(model_.rowCount(), 1);
+    const int state_role = static_cast<int>(VideoListModelRole::kState);
+
+    EXPECT_TRUE(model_.setData(model_.index(0),
+                               QVariant::fromValue(DownloadState::kQueued),
+                               state_role));
+    EXPECT_EQ(db_.download_queue().size(), 1);
+
+    EXPECT_TRUE(model_.setData(model_.index(0),
+                               QVariant::fromValue(DownloadState::kAdded),
+                               state_role));
+    EXPECT_TRUE(db_.download_queue().empty());
+}
+
+TEST_F(VideoListModelTest, RestoreDownloadsInQueueOrder) {
+    db_.addVideos({make_info(0), make_info(1), make_info(2)});
+    db_.enqueueDownload(3);
+    db_.enqueueDownload(1);
+
+    VideoListModel model(db_);
+    QSignalSpy request_download_spy(&model,
+                                    &VideoListModel::requestDownloadVideo);
+
+    model.restoreDownloads();
+
+    EXPECT_EQ(model.rowCount(), 3);
+    ASSERT_EQ(request_download_spy.count(), 2);
+    EXPECT_EQ(try_convert<ManagedVideo*>(request_download_spy[0][0])->id(), 3);
+    EXPECT_EQ(try_convert<ManagedVideo*>(request_download_spy[1][0])->id(), 1);
+}
+
+TEST_F(VideoListModelTest, RestoredDownloadIsSkippedByItsPage) {
+    QList<VideoInfo> infos;
+    for (qint64 i = 0; i < 2 * Database::kChunkSize; ++i) {
+        infos << make_info(i);
+    }
+    db_.addVideos(infos);
+    db_.enqueueDownload(1);
+
+    VideoListModel model(db_);
+    model.restoreDownloads();
+    EXPECT_EQ(model.rowCount(), Database::kChunkSize + 1);
+
+    model.paginate();
+    EXPECT_EQ(model.rowCount(), 2 * Database::kChunkSize);
+}
+
+TEST_F(VideoListModelTest, HistoryChangedElsewhereIsApplied) {
+    model_.appendVideos(parts_asc_);
+    QSignalSpy insert_spy(&model_, &VideoListModel::rowsInserted);
+
+    // Already shown as is, then added elsewhere
+    emit db_.historyChanged({parts_asc_[0], parts_desc_[0]}, {2});
+
+    ASSERT_EQ(model_.rowCount(), 3);
+    EXPECT_EQ(insert_spy.count(), 1);
+    EXPECT_EQ(try_convert<qint64>(model_.data(model_.index(0), kIdRole)), 1);
+    EXPECT_EQ(try_convert<qint64>(model_.data(model_.index(1), kIdRole)), 3);
+    EXPECT_EQ(try_convert<qint64>(model_.data(model_.index(2), kIdRole)), 9);
+}
+
+// e.g., cleared elsewhere, the history is read again except for a download
+TEST_F(VideoListModelTest, ResetElsewhereReloadsHistory) {
+    model_.appendVideos(parts_desc_);
+    model_.setData(model_.index(1), QVariant::fromValue(DownloadState::kQueued),
+                   static_cast<int>(VideoListModelRole::kState));
+    db_.addVideo(make_info(0));
+    ASSERT_EQ(model_.rowCount(), 4);
+
+    emit db_.historyReset();
+
+    ASSERT_EQ(model_.rowCount(), 2);
+    EXPECT_EQ(try_convert<qint64>(model_.data(model_.index(0), kIdRole)), 1);
+    EXPECT_EQ(try_convert<qint64>(model_.data(model_.index(1), kIdRole)), 8);
+}
+
+TEST_F(VideoListModelTest, ResetElsewhereUnloadsOneBlock) {
+    model_.appendVideos(parts_asc_);
+    QSignalSpy remove_spy(&model_, &VideoListModel::rowsRemoved);
+
+    emit db_.historyReset();
+
+    EXPECT_EQ(model_.rowCount(), 0);
+    EXPECT_EQ(remove_spy.count(), 1);
+}
+
+TEST_F(VideoListModelTest, ImportedHistoryIsShown) {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QString file_name = dir.filePath("history.jsonl");
+
+    db_.addVideos({make_info(0), make_info(1)});
+    ASSERT_EQ(db_.export_history(file_name), 2);
+    model_.removeAllVideos();
+
+    db_.importHistory(file_name);
+
+    EXPECT_EQ(model_.rowCount(), 2);
+}
+
+TEST_F(VideoListModelTest, PrunedVideosAreRemoved) {
+    model_.appendVideos(parts_asc_);
+
+    emit db_.videosPruned({1, 3});
+
+    ASSERT_EQ(model_.rowCount(), 1);
+    EXPECT_EQ(try_convert<qint64>(model_.data(model_.index(0), kIdRole)), 2);
+}
+
 TEST_F(VideoListModelTest, SetDataOutOfBoundsIndex) {
     model_.appendVideos(parts_);
 
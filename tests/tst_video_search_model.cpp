@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+#include <qabstractitemmodel.h>
+#include <qlist.h>
+#include <qsignalspy.h>
+#include <qtypes.h>
+#include <qvariant.h>
+
+#include "_tst_util.h"
+#include "gmock/gmock.h"
+#include "video.h"
+#include "video_search_model.h"
+
+using namespace tst_util;  // NOLINT(google-build-using-namespace)
+
+namespace yd_gui {
+
+using VideoSearchModelRole = VideoSearchModel::VideoSearchModelRole;
+
+class VideoSearchModelTest : public testing::Test {
+   protected:
+    explicit VideoSearchModelTest() { EXPECT_TRUE(db_.valid()); }
+
+    // Each has its own video_id so none are deduplicated
+    static VideoInfo make_info(const QString& title, const QString& author) {
+        static qint64 count = 0;
+        return VideoInfo(QString::number(count++), title, author, 1,
+                         "thumbnail", "url", {}, true);
+    }
+
+    qint64 id_at(const int row) {
+        return try_convert<qint64>(model_.data(
+            model_.index(row), static_cast<int>(VideoSearchModelRole::kIdRole)));
+    }
+
+    Database db_{Database::get_temp(QString::fromStdString(test_name()))};
+
+    VideoSearchModel model_{db_};
+};
+
+TEST_F(VideoSearchModelTest, EmptyText) {
+    db_.addVideo(make_info("cats", "someone"));
+
+    model_.setText("");
+
+    EXPECT_EQ(model_.rowCount(), 0);
+    EXPECT_FALSE(model_.canFetchMore(QModelIndex()));
+}
+
+TEST_F(VideoSearchModelTest, SetTextSearches) {
+    db_.addVideos({make_info("cats", "someone"), make_info("dogs", "someone"),
+                   make_info("more cats", "else")});
+
+    model_.setText("cat");
+
+    ASSERT_EQ(model_.rowCount(), 2);
+    EXPECT_EQ(id_at(0), 3);
+    EXPECT_EQ(id_at(1), 1);
+    EXPECT_FALSE(model_.searching());
+}
+
+TEST_F(VideoSearchModelTest, NewTextReplacesResults) {
+    db_.addVideos({make_info("cats", "someone"), make_info("dogs", "someone")});
+
+    model_.setText("cats");
+    EXPECT_EQ(model_.rowCount(), 1);
+
+    model_.setText("someone");
+    EXPECT_EQ(model_.rowCount(), 2);
+}
+
+TEST_F(VideoSearchModelTest, FetchMorePaginates) {
+    QList<VideoInfo> infos;
+    for (qint64 i = 0; i < Database::kChunkSize + 1; ++i) {
+        infos << make_info("cats", "someone");
+    }
+    db_.addVideos(infos);
+
+    model_.setText("cats");
+    EXPECT_EQ(model_.rowCount(), Database::kChunkSize);
+    ASSERT_TRUE(model_.canFetchMore(QModelIndex()));
+
+    model_.fetchMore(QModelIndex());
+    EXPECT_EQ(model_.rowCount(), Database::kChunkSize + 1);
+    EXPECT_FALSE(model_.canFetchMore(QModelIndex()));
+}
+
+}  // namespace yd_gui